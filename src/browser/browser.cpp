@@ -1,13 +1,22 @@
 #include "browser.h"
 #include "browserwindow.h"
 #include "downloadmanagerwidget.h"
+#include "tabwidget.h"
 
 #include <QWebEngineSettings>
 #include <QFile>
+#include <QSettings>
 #include <QDir>
+#include <QDebug>
 
 using namespace Qt::StringLiterals;
 
+namespace {
+
+const QString LegacyFavoritesFile = QStringLiteral("src/favorites/favorites.json");
+
+}
+
 Browser::Browser()
 {
     m_downloadManagerWidget.setAttribute(Qt::WA_QuitOnClose, false);
@@ -15,9 +24,130 @@ Browser::Browser()
     QObject::connect(
         QWebEngineProfile::defaultProfile(), &QWebEngineProfile::downloadRequested,
         &m_downloadManagerWidget, &DownloadManagerWidget::downloadRequested);
+
+    // Une seule connexion et un seul arbre de favoris pour tout le processus
+    const bool databaseReady = m_favoritesDatabase.initDatabase();
+    if (!databaseReady)
+        qWarning() << "Impossible d'initialiser la base de données des favoris";
+    QSettings settings;
+    m_favoritesDatabase.startWorker();
+    const bool faviconsReady = m_faviconStore.open();
+    if (faviconsReady) {
+        if (settings.contains("favicons/byteBudget"))
+            m_faviconStore.setByteBudget(settings.value("favicons/byteBudget").toLongLong());
+        m_faviconStore.startWorker();
+    }
+    m_favoritesModel.reset(new FavoritesModel(&m_favoritesDatabase));
+    m_favoritesModel->load();
+    if (databaseReady)
+        importLegacyData(faviconsReady);
+    m_faviconCache.reset(new FaviconCache(m_favoritesModel.get(), &m_faviconStore));
+    m_faviconFetcher.reset(new FaviconFetcher(&m_faviconStore));
+    QObject::connect(m_faviconFetcher.get(), &FaviconFetcher::faviconReady, m_faviconFetcher.get(),
+                     [this](const QUrl &pageUrl, const QString &ref, bool changed) {
+        handleFaviconReady(pageUrl, ref, changed);
+    });
+    // Historique et favoris indexés hors du thread de l'interface
+    m_omnibox.reset(new OmniboxEngine(m_favoritesModel.get()));
+
+    if (settings.contains("tabs/freezeAfterSecs"))
+        m_tabLifecycle.setFreezeDelay(settings.value("tabs/freezeAfterSecs").toInt());
+    if (settings.contains("tabs/discardAfterSecs"))
+        m_tabLifecycle.setDiscardDelay(settings.value("tabs/discardAfterSecs").toInt());
+    if (settings.contains("tabs/memoryBudget"))
+        m_tabLifecycle.setMemoryBudget(settings.value("tabs/memoryBudget").toLongLong());
+
+    m_sessionStore.open();
+}
+
+Browser::~Browser()
+{
+    // Dernières navigations des fenêtres encore ouvertes
+    for (BrowserWindow *window : std::as_const(m_windows))
+        window->tabWidget()->flushSession();
+}
+
+void Browser::importLegacyData(bool importFavicons)
+{
+    FavoritesModel *model = m_favoritesModel.get();
+    // L'ancien favorites.json n'est plus qu'un format d'import : repris une
+    // fois, et retenté au prochain démarrage tant que la reprise échoue
+    QSettings settings;
+    bool importJson = false;
+    if (!settings.value("favorites/jsonImported").toBool()) {
+        if (QFile::exists(LegacyFavoritesFile))
+            importJson = true;
+        else
+            settings.setValue("favorites/jsonImported", true);
+    }
+    QFuture<bool> favorites = importJson ? m_favoritesDatabase.importJsonAsync(LegacyFavoritesFile)
+                                         : QtFuture::makeReadyValueFuture(false);
+    favorites.then(model, [this, model, importJson, importFavicons](bool imported) {
+        if (importJson) {
+            if (imported)
+                QSettings().setValue("favorites/jsonImported", true);
+            else
+                qWarning() << "Reprise de" << LegacyFavoritesFile << "impossible, le fichier est conservé";
+        }
+        if (!importFavicons) {
+            if (imported)
+                model->load();
+            return;
+        }
+        // Anciens fichiers par hôte : les favoris repris ci-dessus pointent
+        // encore dessus, leurs chemins sont remplacés par les références
+        m_faviconStore.runOnWorker<QHash<QString, QString>>([](FaviconStore *store) {
+            return store->importLegacyFiles();
+        }).then(model, [this, model, imported](const QHash<QString, QString> &paths) {
+            if (paths.isEmpty()) {
+                if (imported)
+                    model->load();
+                return;
+            }
+            m_favoritesDatabase.replaceIconPathsAsync(paths).then(model, [model](bool) {
+                model->load();
+            });
+        });
+    });
+}
+
+bool Browser::restoreSession()
+{
+    const QList<SessionStore::Window> windows = m_sessionStore.load();
+    for (const SessionStore::Window &saved : windows) {
+        // Les onglets restaurés sont les premiers : pas de page vide à refermer
+        BrowserWindow *window = createEmptyWindow(false);
+        window->tabWidget()->restoreSession(saved);
+        if (!window->tabWidget()->count())
+            window->tabWidget()->createTab();
+        window->show();
+    }
+    return !windows.isEmpty();
+}
+
+void Browser::handleFaviconReady(const QUrl &pageUrl, const QString &ref, bool changed)
+{
+    const int id = m_favoritesModel->idForUrl(pageUrl);
+    if (id == -1)
+        return;
+    // Même icône : la relire seulement si elle revient après une éviction
+    if (m_favoritesModel->contains(id) && m_favoritesModel->tree().iconPath(id) == ref) {
+        if (changed)
+            m_faviconCache->reload(id);
+        return;
+    }
+    m_favoritesModel->setFavoriteIcon(id, ref);
 }
 
 BrowserWindow *Browser::createHiddenWindow(bool offTheRecord)
+{
+    BrowserWindow *mainWindow = createEmptyWindow(offTheRecord);
+    if (mainWindow)
+        mainWindow->tabWidget()->createTab();
+    return mainWindow;
+}
+
+BrowserWindow *Browser::createEmptyWindow(bool offTheRecord)
 {
     if (!offTheRecord && !m_profile) {
         const QString name = u"simplebrowser."_s + QLatin1StringView(qWebEngineChromiumVersion());
@@ -40,7 +170,9 @@ BrowserWindow *Browser::createHiddenWindow(bool offTheRecord)
             QObject::connect(mainWindow, &QObject::destroyed, [this, mainWindow]() {
                 m_windows.removeOne(mainWindow);
             });
-            mainWindow->refreshFavoriteIcon(QUrl());
+            if (!offTheRecord && m_sessionStore.isOpen())
+                mainWindow->tabWidget()->setSession(&m_sessionStore, m_sessionStore.addWindow());
+            mainWindow->refreshFavoriteIcon();
         }
     } catch (const std::exception& e) {
         qDebug() << "Exception lors de la création de BrowserWindow:" << e.what();
@@ -60,6 +192,7 @@ BrowserWindow *Browser::createDevToolsWindow()
 {
     auto profile = m_profile ? m_profile.get() : QWebEngineProfile::defaultProfile();
     auto mainWindow = new BrowserWindow(this, profile, true);
+    mainWindow->tabWidget()->createTab();
     m_windows.append(mainWindow);
     QObject::connect(mainWindow, &QObject::destroyed, [this, mainWindow]() {
         m_windows.removeOne(mainWindow);
@@ -68,16 +201,3 @@ BrowserWindow *Browser::createDevToolsWindow()
     return mainWindow;
 }
 
-
-void Browser::ensureFavoritesFileExists()
-{
-    QString filePath = QDir::currentPath() + "/src/favorites/favorites.json";
-    QFile file(filePath);
-    if (!file.exists()) {
-        QDir().mkpath(QFileInfo(filePath).path());
-        if (file.open(QIODevice::WriteOnly)) {
-            file.write("[]");
-            file.close();
-        }
-    }
-}
\ No newline at end of file
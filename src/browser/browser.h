@@ -2,6 +2,14 @@
 #define BROWSER_H
 
 #include "downloadmanagerwidget.h"
+#include "database.h"
+#include "faviconcache.h"
+#include "faviconfetcher.h"
+#include "faviconstore.h"
+#include "favoritesmodel.h"
+#include "omniboxengine.h"
+#include "sessionstore.h"
+#include "tablifecycle.h"
 
 #include <QList>
 #include <QWebEngineProfile>
@@ -14,6 +22,10 @@ class Browser
 {
 public:
     Browser();
+    ~Browser();
+
+    // Rouvre les fenêtres de la session précédente ; faux s'il n'y en a pas
+    bool restoreSession();
 
     QList<BrowserWindow*> windows() { return m_windows; }
 
@@ -22,11 +34,33 @@ public:
     BrowserWindow *createDevToolsWindow();
 
     DownloadManagerWidget &downloadManagerWidget() { return m_downloadManagerWidget; }
-    void ensureFavoritesFileExists();
+    // Favoris partagés par toutes les fenêtres, chargés une seule fois
+    FavoritesModel *favoritesModel() const { return m_favoritesModel.get(); }
+    FaviconCache *faviconCache() const { return m_faviconCache.get(); }
+    FaviconFetcher *faviconFetcher() const { return m_faviconFetcher.get(); }
+    FaviconStore *faviconStore() { return &m_faviconStore; }
+    OmniboxEngine *omnibox() const { return m_omnibox.get(); }
+    TabLifecycleManager *tabLifecycle() { return &m_tabLifecycle; }
 
 private:
+    // Fenêtre sans onglet, inscrite dans la session
+    BrowserWindow *createEmptyWindow(bool offTheRecord);
+    // Anciens favorites.json et fichiers de favicons, repris sur les threads
+    // de travail ; le modèle est relu une fois les favoris et icônes en place
+    void importLegacyData(bool importFavicons);
+
+    void handleFaviconReady(const QUrl &pageUrl, const QString &ref, bool changed);
+
     QList<BrowserWindow*> m_windows;
     DownloadManagerWidget m_downloadManagerWidget;
     QScopedPointer<QWebEngineProfile> m_profile;
+    Database m_favoritesDatabase;
+    FaviconStore m_faviconStore;
+    QScopedPointer<FavoritesModel> m_favoritesModel;
+    QScopedPointer<FaviconCache> m_faviconCache;
+    QScopedPointer<FaviconFetcher> m_faviconFetcher;
+    QScopedPointer<OmniboxEngine> m_omnibox;
+    TabLifecycleManager m_tabLifecycle;
+    SessionStore m_sessionStore;
 };
 #endif // BROWSER_H
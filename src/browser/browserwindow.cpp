@@ -2,6 +2,8 @@
 #include "browserwindow.h"
 #include "../downloads/downloadmanagerwidget.h"
 #include "favoritesmanager.h"
+#include "favoritesbar.h"
+#include "iconcache.h"
 #include "tabwidget.h"
 #include "webview.h"
 // #include "commandwidget.h"
@@ -20,9 +22,6 @@
 #include <QVBoxLayout>
 #include <QWebEngineFindTextResult>
 #include <QWebEngineProfile>
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonObject>
 #include <QComboBox>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
@@ -33,56 +32,64 @@
 #include <QTableWidget>
 #include <QHeaderView>
 #include <QPainter>
+#include <QAbstractItemView>
 #include <QCompleter>
 #include <QFile>
 #include <QStringListModel>
 #include <QDrag>
 #include <QMimeData>
 #include <QFormLayout>
+#include <QDialogButtonBox>
+#include <QTreeWidgetItemIterator>
 #include <QBuffer>
 #include <QTimer>
 
+#include <algorithm>
+
 using namespace Qt::StringLiterals;
 
+namespace {
+
+// Une trame à 60 Hz
+constexpr int FrameIntervalMs = 16;
+
+}
+
 BrowserWindow::BrowserWindow(Browser *browser, QWebEngineProfile *profile, bool forDevTools)
     : m_browser(browser)
     , m_profile(profile)
-    , m_tabWidget(new TabWidget(profile, this))
+    , m_tabWidget(new TabWidget(profile, browser->tabLifecycle(), this))
     , m_progressBar(new QProgressBar(this))
     , m_historyBackAction(nullptr)
     , m_stopAction(nullptr)
     , m_reloadAction(nullptr)
     , m_stopReloadAction(nullptr)
     , m_urlLineEdit(nullptr)
-    , m_favAction(new QAction(this))
     , m_settingsMenu(nullptr)
     , m_settingsAction(nullptr)
     , m_toolbar(createToolBar())
-    , m_favoritesBar(new QToolBar(tr("Favoris"), this))  // Initialisation de la barre de favoris
-    , m_moreFavoritesAction(nullptr)
     , m_favoritesMenu(nullptr)
     , m_urlCompleter(new QCompleter(this))
-    , m_favoritesRoot(new FavoriteItem(-1, "Root", "", "", {}, nullptr)) // Initialisation de m_favoritesRoot
 {
     setAttribute(Qt::WA_DeleteOnClose, true);
     setFocusPolicy(Qt::ClickFocus);
 
-    // Initialiser la base de données
-    if (!m_database.initDatabase()) {
-        QMessageBox::critical(this, tr("Erreur"), tr("Impossible d'initialiser la base de données"));
-        return;
-    }
+    // Favoris partagés par toutes les fenêtres : déjà chargés par Browser,
+    // ouvrir une fenêtre ne touche pas la base de données
+    m_favoritesModel = browser->favoritesModel();
+    m_favoritesBar = new FavoritesBar(m_favoritesModel, browser->faviconCache(), this);
+    connect(m_favoritesModel, &FavoritesModel::modelReset, this, &BrowserWindow::scheduleFavoriteState);
+    // La barre, les menus de dossiers et les suggestions suivent le modèle d'eux-mêmes
+    connect(m_favoritesModel, &FavoritesModel::itemInserted, this, &BrowserWindow::scheduleFavoriteState);
+    connect(m_favoritesModel, &FavoritesModel::itemRemoved, this, &BrowserWindow::scheduleFavoriteState);
+    connect(m_favoritesModel, &FavoritesModel::itemChanged, this, &BrowserWindow::scheduleFavoriteState);
 
     if (!forDevTools) {
         addToolBar(m_toolbar);
 
         // Barre de favoris ajoutée avant les onglets
-        m_favoritesBar->setMovable(false);
-
         setupFavoritesBar();
         setupFavoritesMenu();
-        loadFavoritesToBar();
-        updateUrlCompleter();
 
         menuBar()->addMenu(createFileMenu(m_tabWidget));
         menuBar()->addMenu(createEditMenu());
@@ -113,27 +120,10 @@ BrowserWindow::BrowserWindow(Browser *browser, QWebEngineProfile *profile, bool
 
     layout->addWidget(m_favoritesBar);
 
-    m_favAction = new QAction(this);
-    if (m_favAction) {
-        // Définir l'icône initiale
-        QColor initialColor = Qt::white; // Couleur initiale
-        QPixmap pix(16, 16);
-        pix.fill(Qt::transparent);
-        QPainter painter(&pix);
-        painter.setPen(QPen(initialColor));
-        painter.setFont(QFont("Arial", 10, QFont::Bold));
-        painter.drawText(pix.rect(), Qt::AlignCenter, "F");
-        m_favAction->setIcon(QIcon(pix));
-    } else {
-        qDebug() << "m_favAction is null in BrowserWindow constructor";
-    }
-    if (m_favAction) {
-        m_favAction->setToolTip(tr("Ajouter/Supprimer des favoris"));
-    } else {
-        qDebug() << "m_favAction is null when setting tooltip";
-    }
-
-    connect(m_favAction, &QAction::triggered, this, &BrowserWindow::handleFavActionTriggered);
+    m_favoriteMenu = createFavoriteContextMenu();
+    m_favoriteStateTimer.setSingleShot(true);
+    m_favoriteStateTimer.setInterval(FrameIntervalMs);
+    connect(&m_favoriteStateTimer, &QTimer::timeout, this, &BrowserWindow::updateFavoriteState);
 
 
     layout->addWidget(m_tabWidget);
@@ -142,24 +132,18 @@ BrowserWindow::BrowserWindow(Browser *browser, QWebEngineProfile *profile, bool
 
     if (m_tabWidget) {
         connect(m_tabWidget, &TabWidget::titleChanged, this, &BrowserWindow::handleWebViewTitleChanged);
-        connect(m_tabWidget, &TabWidget::currentChanged, this, [this](int index) {
-            if (WebView *view = m_tabWidget->currentWebView()) {
-                updateFavoriteIcon(view->url()); // Mise à jour immédiate de l'icône au changement d'onglet
-                connect(view, &WebView::loadFinished, this, [this](bool ok) {
-                    updateFavoriteIcon(currentTab()->url(), ok);
-                });
-            }
-        });
+        // Les signaux de chaque vue sont branchés une fois pour toutes par
+        // TabWidget::setupView ; ici, seulement ceux de l'onglet courant
+        connect(m_tabWidget, &TabWidget::currentChanged, this, &BrowserWindow::scheduleFavoriteState);
     }
-    connect(m_tabWidget, &TabWidget::urlChanged, this, [this](const QUrl &url) {
-        updateFavoriteIcon(url);
-    });
-    connect(m_tabWidget, &TabWidget::favIconChanged, this, [this](const QIcon &icon) {
-        WebView *view = currentTab();
-        if (view) {
-            updateFavoriteIcon(view->url());
-        }
+    connect(m_tabWidget, &TabWidget::urlChanged, this, &BrowserWindow::scheduleFavoriteState);
+    connect(m_tabWidget, &TabWidget::pageLoadFinished, this, &BrowserWindow::handleWebViewLoadFinished);
+    connect(m_tabWidget, &TabWidget::pageIconChanged, this, [this](const QUrl &url, const QIcon &icon) {
+        // Icône déjà chargée par le moteur : enregistrée sans nouvelle requête
+        if (!m_profile->isOffTheRecord())
+            m_browser->faviconFetcher()->storePageIcon(url, icon);
     });
+    connect(m_tabWidget, &TabWidget::favIconChanged, this, &BrowserWindow::scheduleFavoriteState);
 
     if (!forDevTools) {
         if (m_tabWidget) {
@@ -172,7 +156,6 @@ BrowserWindow::BrowserWindow(Browser *browser, QWebEngineProfile *profile, bool
         connect(m_tabWidget, &TabWidget::urlChanged, [this](const QUrl &url) {
             m_urlLineEdit->setText(url.toDisplayString());
         });
-        connect(m_tabWidget, &TabWidget::favIconChanged, m_favAction, &QAction::setIcon);
         connect(m_tabWidget, &TabWidget::devToolsRequested, this, &BrowserWindow::handleDevToolsRequested);
         connect(m_urlLineEdit, &QLineEdit::returnPressed, [this]() {
             m_tabWidget->setUrl(QUrl::fromUserInput(m_urlLineEdit->text()));
@@ -210,17 +193,24 @@ BrowserWindow::BrowserWindow(Browser *browser, QWebEngineProfile *profile, bool
     QShortcut *duplicateTabShortcut = new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_D), this);
     connect(duplicateTabShortcut, &QShortcut::activated, this, &BrowserWindow::duplicateCurrentTab);
 
-    m_urlCompleter = new QCompleter(this);
-    m_urlCompleter->setFilterMode(Qt::MatchContains);
-    m_urlCompleter->setCaseSensitivity(Qt::CaseInsensitive);
+    // Le moteur filtre et classe déjà : le compléteur affiche sa liste telle quelle
+    m_urlCompleterModel = new QStringListModel(m_urlCompleter);
+    m_urlCompleter->setModel(m_urlCompleterModel);
+    m_urlCompleter->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
     m_urlLineEdit->setCompleter(m_urlCompleter);
+    connect(m_urlLineEdit, &QLineEdit::textEdited, this, [this](const QString &text) {
+        m_omniboxQuery = m_browser->omnibox()->complete(text);
+        if (text.trimmed().isEmpty())
+            showUrlSuggestions(m_omniboxQuery, {});
+    });
+    connect(m_browser->omnibox(), &OmniboxEngine::suggestionsReady, this,
+            [this](int query, const QList<OmniboxSuggestion> &suggestions) {
+        showUrlSuggestions(query, suggestions);
+    });
+
+    m_favoritesManager = new FavoritesManager(m_favoritesModel, browser->faviconCache(), this);
 
-    m_favoritesManager = new FavoritesManager(this);
-    m_favoritesRoot = new FavoriteItem(-1, "Root", "", "", {}, nullptr);
-    
-    loadFavoritesFromDatabase();
     handleWebViewTitleChanged(QString());
-    m_tabWidget->createTab();
 }
 
 QSize BrowserWindow::sizeHint() const
@@ -520,8 +510,8 @@ QToolBar *BrowserWindow::createToolBar()
             &m_browser->downloadManagerWidget(), &QWidget::show);
 
     // Bouton "Favoris'
-    auto m_favAction = new QAction(this);
-    m_favAction->setIcon(QIcon(":/star-regular.png"));
+    m_favAction = new QAction(this);
+    m_favAction->setIcon(IconCache::glyphIcon(u'F', Qt::white));
     m_favAction->setToolTip(tr("Ajouter/Supprimer des favoris"));
     navigationBar->addAction(m_favAction);
     connect(m_favAction, &QAction::triggered, this, &BrowserWindow::handleFavActionTriggered);
@@ -627,6 +617,17 @@ void BrowserWindow::closeEvent(QCloseEvent *event)
         }
     }
     event->accept();
+
+    // Une fenêtre fermée quitte la session, sauf la dernière : elle sera
+    // rouverte au prochain démarrage
+    const QList<BrowserWindow*> windows = m_browser->windows();
+    const bool last = std::none_of(windows.cbegin(), windows.cend(), [this](BrowserWindow *window) {
+        return window != this && window->tabWidget()->hasSession();
+    });
+    if (last)
+        m_tabWidget->flushSession();
+    else
+        m_tabWidget->dropSession();
     deleteLater();
 }
 
@@ -689,276 +690,18 @@ void BrowserWindow::handleFindTextFinished(const QWebEngineFindTextResult &resul
 }
 
 
-void BrowserWindow::saveFavorite(const QUrl &url, const QString &title)
-{
-    QFile file("src/favorites/favorites.json");
-
-    QJsonArray favoritesArray;
-    if (file.open(QIODevice::ReadOnly)) {
-        QJsonDocument loadDoc = QJsonDocument::fromJson(file.readAll());
-        favoritesArray = loadDoc.array();
-        file.close();
-    }
-
-    // Vérificiation pour éviter les doublons
-    for (const QJsonValue &value : favoritesArray) {
-        if (value.toObject().value("url").toString() == url.toString()) {
-            QMessageBox::information(this, tr("Favoris"), tr("Ce favori existe déjà."));
-            return;
-        }
-    }
-
-    // Ajouter le nouvel élément
-    QJsonObject newFavorite;
-    newFavorite["title"] = title;
-    newFavorite["url"] = url.toString();
-    favoritesArray.append(newFavorite);
-
-    // Sauvegarde dans le fichier JSON
-    if (file.open(QIODevice::WriteOnly)) {
-        QJsonDocument saveDoc(favoritesArray);
-        file.write(saveDoc.toJson());
-        file.close();
-    }
-    loadFavoritesToBar();
-}
-
-
-void BrowserWindow::loadFavorites()
-{
-    QFile file("src/favorites/favorites.json");
-    if (!file.open(QIODevice::ReadOnly))
-        return;
-
-    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-    QJsonArray favoritesArray = doc.array();
-
-    for (const QJsonValue &value : favoritesArray) {
-        QJsonObject obj = value.toObject();
-        qDebug() << "Favori chargé:" << obj["title"].toString() << obj["url"].toString();
-    }
-    file.close();
-}
-
-
 void BrowserWindow::setupFavoritesBar() {
-    m_favoritesBar->clear();
-    m_favoritesBar->setMovable(true);
-    m_favoritesBar->setAcceptDrops(true);
+    // La barre se tient à jour seule à partir du modèle
     m_favoritesBar->setContextMenuPolicy(Qt::CustomContextMenu);
-    m_favoritesBar->installEventFilter(this);
-
-    connect(m_favoritesBar, &QToolBar::customContextMenuRequested, this, &BrowserWindow::showFavoriteContextMenu);
-
-    // Gestion du drag-drop manuel
-    m_favoritesBar->setAcceptDrops(true);
-
-     // Ajouter le bouton "Voir plus" seulement s'il y a des favoris
-     if (!m_favoritesRoot->children.isEmpty()) {
-        m_moreFavoritesAction = new QAction(QIcon(":/icons/more.png"), tr("Voir plus..."), this);
-        connect(m_moreFavoritesAction, &QAction::triggered, this, &BrowserWindow::showFavoritesManager);
-        m_favoritesBar->addAction(m_moreFavoritesAction);
-    }
-}
-
-bool BrowserWindow::eventFilter(QObject *watched, QEvent *event) {
-    if (watched == m_favoritesBar) {
-        if (event->type() == QEvent::MouseButtonPress) {
-            QMouseEvent *mouseEvent = static_cast<QMouseEvent*>(event);
-            QAction *action = m_favoritesBar->actionAt(mouseEvent->pos());
-            if (action && action != m_moreFavoritesAction) {
-                m_draggedIndex = m_favoritesBar->actions().indexOf(action);
-                return true;
-            }
-        }
-        else if (event->type() == QEvent::MouseMove && m_draggedIndex != -1) {
-            QMouseEvent *mouseEvent = static_cast<QMouseEvent*>(event);
-            if (mouseEvent->buttons() & Qt::LeftButton) {
-                // Logique de déplacement visuel ici
-            }
-        }
-        else if (event->type() == QEvent::MouseButtonRelease) {
-            QMouseEvent *mouseEvent = static_cast<QMouseEvent*>(event);
-            QAction *targetAction = m_favoritesBar->actionAt(mouseEvent->pos());
-            if (targetAction && m_draggedIndex != -1) {
-                int newIndex = m_favoritesBar->actions().indexOf(targetAction);
-                
-                // Mise à jour de la structure de données
-                if (newIndex != -1 && newIndex != m_draggedIndex) {
-                    m_favoritesRoot->children.move(m_draggedIndex, newIndex);
-                    loadFavoritesToBar();
-                }
-                m_draggedIndex = -1;
-                return true;
-            }
-        }
-    }
-    return QMainWindow::eventFilter(watched, event);
-}
-
-
-
-void BrowserWindow::handleFavoriteDrop(QDropEvent *event) {
-    if (m_draggedIndex == -1) return;
-
-    QPoint pos = event->position().toPoint();
-    int newIndex = m_favoritesBar->actions().indexOf(m_favoritesBar->actionAt(pos));
-
-    if (newIndex != -1 && newIndex != m_draggedIndex) {
-        // Échanger les éléments dans la structure de données
-        m_favoritesRoot->children.swapItemsAt(m_draggedIndex, newIndex);
-        
-        // Mettre à jour l'interface
-        loadFavoritesToBar();
-    }
-    
-    m_draggedIndex = -1;
-}
-
-void BrowserWindow::loadFavoritesToBar() {
-    m_favoritesBar->clear();
-
-    std::function<void(FavoriteItem*, QWidget*)> addFavoritesToBar;
-    addFavoritesToBar = [this, &addFavoritesToBar](FavoriteItem* item, QWidget* parent) {
-        if (item->url.isEmpty()) {
-            // C'est un dossier
-            QMenu* folderMenu = new QMenu(item->title, parent);
-            folderMenu->setIcon(QIcon(":/icons/folder.png"));
-            for (FavoriteItem* child : item->children) {
-                addFavoritesToBar(child, folderMenu);
-            }
-            if (parent == m_favoritesBar) {
-                m_favoritesBar->addAction(folderMenu->menuAction());
-            } else {
-                static_cast<QMenu*>(parent)->addMenu(folderMenu);
-            }
-        } else {
-            // C'est un favori
-            QAction* action = new QAction(item->title, parent);
-            action->setIcon(QIcon(item->iconPath.isEmpty() ? ":/icons/favicon.png" : item->iconPath));
-            action->setData(QUrl(item->url));
-            connect(action, &QAction::triggered, this, [this, url = QUrl(item->url)]() {
-                m_tabWidget->setUrl(url);
-            });
-            if (parent == m_favoritesBar) {
-                m_favoritesBar->addAction(action);
-            } else {
-                static_cast<QMenu*>(parent)->addAction(action);
-            }
-        }
-    };
-
-    for (FavoriteItem* item : m_favoritesRoot->children) {
-        addFavoritesToBar(item, m_favoritesBar);
-    }
-
-    // Ajouter le bouton "Voir plus" seulement s'il y a des favoris
-    if (!m_favoritesRoot->children.isEmpty()) {
-        m_moreFavoritesAction = new QAction(QIcon(":/icons/more.png"), tr("Voir plus..."), this);
-        connect(m_moreFavoritesAction, &QAction::triggered, this, &BrowserWindow::showFavoritesManager);
-        m_favoritesBar->addAction(m_moreFavoritesAction);
-    }
-}
-
-
-
-
-void BrowserWindow::startDrag()
-{
-    QAction *action = qobject_cast<QAction*>(sender());
-    if (!action) return;
-
-    m_draggedIndex = m_favoritesBar->actions().indexOf(action);
-
-    QDrag *drag = new QDrag(this);
-    QMimeData *mimeData = new QMimeData;
-    mimeData->setText(action->text());
-    drag->setMimeData(mimeData);
-    drag->exec(Qt::MoveAction);
-}
-
-void BrowserWindow::addFavoriteToBar(FavoriteItem* item, QWidget* parent)
-{
-    if (item->url.isEmpty()) {
-        // Gestion des dossiers
-        QMenu* folderMenu = new QMenu(item->title, parent);
-        folderMenu->setIcon(QIcon(":/3rdparty/folder-closed.png"));
-
-        for (FavoriteItem* child : item->children) {
-            addFavoriteToBar(child, folderMenu);
-        }
-
-        if (folderMenu->isEmpty()) {
-            QAction* emptyAction = new QAction(tr("Dossier vide"), folderMenu);
-            emptyAction->setEnabled(false);
-            folderMenu->addAction(emptyAction);
-        }
-
-        if (QToolBar* tb = qobject_cast<QToolBar*>(parent)) {
-            tb->addAction(folderMenu->menuAction());
-        }
-    } else {
-        // C'est un favori
-        QAction* action = new QAction(parent);
-        action->setText(item->title);
-        action->setToolTip(item->url);
-
-        if (!item->iconPath.isEmpty()) {
-            action->setIcon(QIcon(item->iconPath));
-        } else {
-            // Générer une icône à partir de la première lettre
-            QPixmap pix(16, 16);
-            pix.fill(Qt::transparent);
-            QPainter painter(&pix);
-            painter.setPen(Qt::black);
-            painter.setFont(QFont("Arial", 10, QFont::Bold));
-            painter.drawText(pix.rect(), Qt::AlignCenter, item->title.left(1).toUpper());
-            action->setIcon(QIcon(pix));
-        }
-        action->setData(QUrl(item->url));
-
-        connect(action, &QAction::triggered, this, [this, item]() {
-            m_tabWidget->setUrl(QUrl(item->url));
-        });
-
-        if (QToolBar* tb = qobject_cast<QToolBar*>(parent)) {
-            tb->addAction(action);
-        }
-    }
-}
-
-void BrowserWindow::loadFavoritesToBarRecursive(const QJsonArray& array, QWidget* parent)
-{
-    for (const QJsonValue &value : array) {
-        QJsonObject obj = value.toObject();
-        QString name = obj["name"].toString();
-        QString url = obj["url"].toString();
-
-        if (obj.contains("children")) {
-            QMenu* subMenu = new QMenu(name, parent);
-            loadFavoritesToBarRecursive(obj["children"].toArray(), subMenu);
-            if (parent == m_favoritesBar) {
-                m_favoritesBar->addAction(subMenu->menuAction());
-            } else {
-                static_cast<QMenu*>(parent)->addMenu(subMenu);
-            }
-        } else {
-            QAction* action = new QAction(name, parent);
-            connect(action, &QAction::triggered, this, [this, url]() {
-                openFavorite(QUrl(url));
-            });
-            if (parent == m_favoritesBar) {
-                m_favoritesBar->addAction(action);
-            } else {
-                static_cast<QMenu*>(parent)->addAction(action);
-            }
-        }
-    }
+    connect(m_favoritesBar, &QWidget::customContextMenuRequested, this, &BrowserWindow::showFavoriteContextMenu);
+    connect(m_favoritesBar, &FavoritesBar::favoriteTriggered, this, [this](const QUrl &url) {
+        m_tabWidget->setUrl(url);
+    });
+    connect(m_favoritesBar, &FavoritesBar::moreRequested, this, &BrowserWindow::showFavoritesManager);
 }
 
 void BrowserWindow::showFavoriteContextMenu(const QPoint &pos)
 {
-    QAction *clickedAction = m_favoritesBar->actionAt(pos);
     QUrl currentUrl = currentTab()->url();
     QString currentTitle = currentTab()->title();
 
@@ -971,55 +714,36 @@ void BrowserWindow::showFavoriteContextMenu(const QPoint &pos)
         tr("Nom du dossier:"), QLineEdit::Normal, "", &ok);
         if (ok && !folderName.isEmpty()) {
             // Ajouter le dossier à la base de données
-            int newFolderId = m_database.addFavorite(folderName, "", "", 0);
-            if (newFolderId != -1) {
-                loadFavoritesFromDatabase();
-                loadFavoritesToBar();
-            }
+            m_favoritesModel->addFolder(folderName);
         }
     });
 
-    if (clickedAction && clickedAction != m_moreFavoritesAction) {
+    const int clickedId = m_favoritesBar->favoriteAt(pos);
+    if (clickedId != -1) {
         // Mode Édition pour un favori existant
-        QUrl actionUrl = clickedAction->data().toUrl();
-        QString actionTitle = clickedAction->text();
-        
         QAction *editAction = contextMenu.addAction(tr("✎ Modifier"));
         QAction *deleteAction = contextMenu.addAction(tr("🗑 Supprimer"));
         QAction *moveAction = contextMenu.addAction(tr("➔ Déplacer vers..."));
 
-        connect(deleteAction, &QAction::triggered, [this, actionUrl]() {
-            deleteFavorite(actionUrl);
+        connect(deleteAction, &QAction::triggered, [this, clickedId]() {
+            m_favoritesModel->removeFavorite(clickedId);
         });
 
-        connect(editAction, &QAction::triggered, [this, actionUrl]() {
-            FavoriteItem* item = findFavoriteByUrl(actionUrl);
-            if(item) editFavorite(item);
+        connect(editAction, &QAction::triggered, [this, clickedId]() {
+            if (m_favoritesModel->contains(clickedId))
+                editFavorite(clickedId);
         });
 
-        connect(moveAction, &QAction::triggered, [this, actionUrl]() {
+        connect(moveAction, &QAction::triggered, [this, clickedId]() {
             QDialog moveDialog(this);
             QVBoxLayout layout(&moveDialog);
             
             QTreeWidget folderTree;
             folderTree.setHeaderLabel(tr("Dossiers"));
-            populateFolderTree(&folderTree, m_favoritesRoot);
+            populateFolderTree(&folderTree);
             
             QPushButton newFolderBtn(tr("Nouveau dossier"));
-            connect(&newFolderBtn, &QPushButton::clicked, [&]() {
-                bool ok;
-                QString name = QInputDialog::getText(&moveDialog, tr("Nouveau dossier"), 
-                                                    tr("Nom:"), QLineEdit::Normal, "", &ok);
-                if(ok && !name.isEmpty()) {
-                    FavoriteItem* newFolder = new FavoriteItem{-1, name, "", "", {}, m_favoritesRoot};
-                    m_favoritesRoot->children.append(newFolder);
-                    
-                    // Ajouter au tree widget
-                    QTreeWidgetItem* treeItem = new QTreeWidgetItem({name});
-                    treeItem->setData(0, Qt::UserRole, QVariant::fromValue(newFolder));
-                    folderTree.invisibleRootItem()->addChild(treeItem);
-                }
-            });
+            setupNewFolderButton(&newFolderBtn, &folderTree, &moveDialog);
 
             layout.addWidget(&folderTree);
             layout.addWidget(&newFolderBtn);
@@ -1031,16 +755,7 @@ void BrowserWindow::showFavoriteContextMenu(const QPoint &pos)
             connect(&buttons, &QDialogButtonBox::rejected, &moveDialog, &QDialog::reject);
 
             if(moveDialog.exec() == QDialog::Accepted) {
-                FavoriteItem* targetFolder = getSelectedFolder(&folderTree);
-                FavoriteItem* item = findFavoriteByUrl(actionUrl);
-                if(item && targetFolder) {
-                    // Retirer de l'ancien parent
-                    if(item->parent) item->parent->children.removeAll(item);
-                    // Ajouter au nouveau parent
-                    item->parent = targetFolder;
-                    targetFolder->children.append(item);
-                    loadFavoritesToBar();
-                }
+                m_favoritesModel->moveFavorite(clickedId, getSelectedFolder(&folderTree));
             }
         });
 
@@ -1058,24 +773,11 @@ void BrowserWindow::showFavoriteContextMenu(const QPoint &pos)
             QLineEdit urlEdit(currentUrl.toString());
             QTreeWidget folderTree;
             folderTree.setHeaderLabel(tr("Dossiers"));
-            populateFolderTree(&folderTree, m_favoritesRoot);
+            populateFolderTree(&folderTree);
             
             // Bouton nouveau dossier
             QPushButton newFolderBtn(tr("Nouveau dossier"));
-            connect(&newFolderBtn, &QPushButton::clicked, [&]() {
-                bool ok;
-                QString name = QInputDialog::getText(&dialog, tr("Nouveau dossier"), 
-                                                    tr("Nom:"), QLineEdit::Normal, "", &ok);
-                if(ok && !name.isEmpty()) {
-                    FavoriteItem* newFolder = new FavoriteItem{-1, name, "", "", {}, m_favoritesRoot};
-                    m_favoritesRoot->children.append(newFolder);
-                    
-                    // Mettre à jour l'arborescence
-                    QTreeWidgetItem* treeItem = new QTreeWidgetItem({name});
-                    treeItem->setData(0, Qt::UserRole, QVariant::fromValue(newFolder));
-                    folderTree.invisibleRootItem()->addChild(treeItem);
-                }
-            });
+            setupNewFolderButton(&newFolderBtn, &folderTree, &dialog);
 
             form.addRow(tr("Titre:"), &titleEdit);
             form.addRow(tr("URL:"), &urlEdit);
@@ -1089,10 +791,7 @@ void BrowserWindow::showFavoriteContextMenu(const QPoint &pos)
             connect(&buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
 
             if(dialog.exec() == QDialog::Accepted) {
-                FavoriteItem* selectedFolder = getSelectedFolder(&folderTree);
-                if(selectedFolder) {
-                    addFavoriteToFolder(titleEdit.text(), urlEdit.text(), selectedFolder);
-                }
+                addFavoriteToFolder(titleEdit.text(), urlEdit.text(), getSelectedFolder(&folderTree));
             }
         });
     }
@@ -1100,41 +799,31 @@ void BrowserWindow::showFavoriteContextMenu(const QPoint &pos)
     contextMenu.exec(m_favoritesBar->mapToGlobal(pos));
 }
 
-void BrowserWindow::editFavorite(FavoriteItem* item)
+void BrowserWindow::editFavorite(int id)
 {
+    const FavoritesTree &tree = m_favoritesModel->tree();
+
     QDialog dialog(this);
     dialog.setWindowTitle(tr("Modifier le favori"));
     QFormLayout form(&dialog);
 
-    QLineEdit titleEdit(item->title);
-    QLineEdit urlEdit(item->url);
+    QLineEdit titleEdit(tree.title(id));
+    QLineEdit urlEdit(tree.url(id));
     
     QTreeWidget folderTree;
     folderTree.setHeaderLabel(tr("Dossiers"));
-    populateFolderTree(&folderTree, m_favoritesRoot);
+    populateFolderTree(&folderTree);
     
     // Sélectionner le dossier actuel
-    QTreeWidgetItem* currentFolderItem = findTreeItem(&folderTree, item->parent);
+    QTreeWidgetItem* currentFolderItem = findTreeItem(&folderTree, tree.parentId(id));
     if(currentFolderItem) folderTree.setCurrentItem(currentFolderItem);
 
     QPushButton newFolderBtn(tr("Nouveau dossier"));
-    connect(&newFolderBtn, &QPushButton::clicked, [&]() {
-        bool ok;
-        QString name = QInputDialog::getText(&dialog, tr("Nouveau dossier"), 
-                                          tr("Nom:"), QLineEdit::Normal, "", &ok);
-        if(ok && !name.isEmpty()) {
-            FavoriteItem* newFolder = new FavoriteItem{-1, name, "", "", {}, m_favoritesRoot};
-            m_favoritesRoot->children.append(newFolder);
-            
-            QTreeWidgetItem* treeItem = new QTreeWidgetItem({name});
-            treeItem->setData(0, Qt::UserRole, QVariant::fromValue(newFolder));
-            folderTree.invisibleRootItem()->addChild(treeItem);
-        }
-    });
+    setupNewFolderButton(&newFolderBtn, &folderTree, &dialog);
 
     QPushButton deleteBtn(tr("Supprimer"));
     connect(&deleteBtn, &QPushButton::clicked, [&]() {
-        deleteFavorite(QUrl(item->url));
+        m_favoritesModel->removeFavorite(id);
         dialog.reject();
     });
 
@@ -1146,28 +835,51 @@ void BrowserWindow::editFavorite(FavoriteItem* item)
     QDialogButtonBox buttons(QDialogButtonBox::Save | QDialogButtonBox::Cancel);
     form.addRow(&buttons);
     form.addRow(&deleteBtn);
+    connect(&buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(&buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
 
     if(dialog.exec() == QDialog::Accepted) {
-        item->title = titleEdit.text();
-        item->url = urlEdit.text();
-        
+        // L'élément peut disparaître pendant que le dialogue est ouvert
+        if (!tree.contains(id))
+            return;
+
+        if (tree.title(id) != titleEdit.text() || tree.url(id) != urlEdit.text())
+            m_favoritesModel->updateFavorite(id, titleEdit.text(), urlEdit.text());
+
         // Déplacer dans le nouveau dossier
-        FavoriteItem* targetFolder = getSelectedFolder(&folderTree);
-        if(targetFolder && item->parent != targetFolder) {
-            item->parent->children.removeAll(item);
-            item->parent = targetFolder;
-            targetFolder->children.append(item);
-        }
-        
-        loadFavoritesToBar();
+        const int targetFolder = getSelectedFolder(&folderTree);
+        if (tree.parentId(id) != targetFolder)
+            m_favoritesModel->moveFavorite(id, targetFolder);
     }
 }
 
-QTreeWidgetItem* BrowserWindow::findTreeItem(QTreeWidget* tree, FavoriteItem* target)
+void BrowserWindow::setupNewFolderButton(QPushButton *button, QTreeWidget *folderTree, QDialog *dialog)
 {
+    connect(button, &QPushButton::clicked, dialog, [this, dialog]() {
+        bool ok;
+        QString name = QInputDialog::getText(dialog, tr("Nouveau dossier"),
+                                             tr("Nom:"), QLineEdit::Normal, "", &ok);
+        if (ok && !name.isEmpty())
+            m_favoritesModel->addFolder(name);
+    });
+
+    // Le dossier apparaît dans l'arborescence dès que la base l'a créé
+    connect(m_favoritesModel, &FavoritesModel::itemInserted, dialog, [this, folderTree](int id) {
+        if (!m_favoritesModel->tree().isFolder(id))
+            return;
+        populateFolderTree(folderTree);
+        if (QTreeWidgetItem *treeItem = findTreeItem(folderTree, id))
+            folderTree->setCurrentItem(treeItem);
+    });
+}
+
+QTreeWidgetItem* BrowserWindow::findTreeItem(QTreeWidget* tree, int id)
+{
+    if (id == FavoritesModel::RootId)
+        return nullptr;
     QTreeWidgetItemIterator it(tree);
     while(*it) {
-        if((*it)->data(0, Qt::UserRole).value<FavoriteItem*>() == target)
+        if((*it)->data(0, Qt::UserRole).toInt() == id)
             return *it;
         ++it;
     }
@@ -1193,8 +905,6 @@ void BrowserWindow::setupFavoritesMenu()
     connect(manageFavoritesAction, &QAction::triggered, this, &BrowserWindow::showFavoritesManager);
 
     m_favoritesMenu->addSeparator();
-
-    loadFavorites();
 }
 
 
@@ -1213,10 +923,9 @@ void BrowserWindow::addCurrentPageToFavorites()
     }
 }
 
-FavoriteItem* BrowserWindow::getSelectedFolderFromTree(QTreeWidget* tree)
+int BrowserWindow::getSelectedFolderFromTree(QTreeWidget* tree)
 {
-    QTreeWidgetItem* selected = tree->currentItem();
-    return selected ? selected->data(0, Qt::UserRole).value<FavoriteItem*>() : m_favoritesRoot;
+    return getSelectedFolder(tree);
 }
 
 
@@ -1224,22 +933,20 @@ FavoriteItem* BrowserWindow::getSelectedFolderFromTree(QTreeWidget* tree)
 
 bool BrowserWindow::addFavorite(const QString &name, const QString &url, const QString &iconPath, int parentId)
 {
-    bool success = m_database.addFavorite(name, url, iconPath, parentId);
-    if (success) {
-        loadFavoritesFromDatabase();
-        loadFavoritesToBar();
-    }
-    return success;
+    // La barre et l'étoile sont mises à jour par les signaux du modèle
+    m_favoritesModel->addFavorite(name, url, iconPath, parentId);
+    return true;
 }
 
 
 bool BrowserWindow::deleteFavorite(const QUrl& url)
 {
-    auto favoriteData = m_database.getFavoriteByUrl(url);
-    if(!favoriteData.isEmpty()) {
-        return m_database.deleteFavorite(favoriteData["id"].toInt());
-    }
-    return false;
+    const int id = m_favoritesModel->idForUrl(url);
+    if (id == -1)
+        return false;
+
+    m_favoritesModel->removeFavorite(id);
+    return true;
 }
 
 
@@ -1251,22 +958,22 @@ void BrowserWindow::handleFavActionTriggered()
 
     QUrl url = view->url();
     QString title = view->title();
-    QIcon favicon = view->favIcon();
 
+    // L'écriture se fait sur le thread SQLite ; l'étoile est mise à jour à la
+    // fin. D'ici là le bouton est inactif : un double clic ajouterait deux fois
+    // la même page
+    m_favAction->setEnabled(false);
     if (isFavorite(url)) {
         // Supprimer le favori
-        if (m_database.deleteFavorite(m_database.getFavoriteByUrl(url)["id"].toInt())) {
-            loadFavoritesFromDatabase();
-            loadFavoritesToBar();
-        }
+        m_favoritesModel->removeFavorite(m_favoritesModel->idForUrl(url)).then(this, [this](bool) {
+            m_favAction->setEnabled(true);
+        });
     } else {
         // Ajouter le favori
-        if (m_database.addFavorite(title, url.toString(), "", 0) != -1) {
-            loadFavoritesFromDatabase();
-            loadFavoritesToBar();
-        }
+        m_favoritesModel->addFavorite(title, url.toString()).then(this, [this](int) {
+            m_favAction->setEnabled(true);
+        });
     }
-    updateFavoriteIcon(url);
 
     // auto favoriteData = m_database.getFavoriteByUrl(url);
     
@@ -1322,224 +1029,129 @@ void BrowserWindow::handleFavActionTriggered()
 
 bool BrowserWindow::isFavorite(const QUrl &url) const
 {
-    auto favoriteData = m_database.getFavoriteByUrl(url);
-    return !favoriteData.isEmpty();
+    return m_favoritesModel->isFavorite(url);
 }
 
 
 bool BrowserWindow::updateFavorite(int id, const QString &newTitle, const QString &newUrl, int parentId)
 {
-    return m_database.updateFavorite(id, newTitle, newUrl, parentId);
-}
+    if (!m_favoritesModel->contains(id))
+        return false;
 
-
-void BrowserWindow::handleWebViewLoadFinished(bool ok)
-{
-    if (ok) {
-        WebView *view = qobject_cast<WebView*>(sender());
-        if (view) {
-            QUrl url = view->url();
-            updateFavoriteIcon(url);
-            QString faviconUrl = url.scheme() + "://" + url.host() + "/favicon.ico";
-
-            // Télécharger la favicon
-            QNetworkAccessManager *manager = new QNetworkAccessManager(this);
-            connect(manager, &QNetworkAccessManager::finished, this, [this, url, manager](QNetworkReply *reply) {
-                if (reply->error() == QNetworkReply::NoError) {
-                    QByteArray data = reply->readAll();
-                    QString faviconPath = saveFavicon(data, url);
-                    updateFaviconForFavorite(url, faviconPath);
-                    QIcon icon(faviconPath);
-                    updateFaviconInFavoritesBar(url, icon);
-                }
-                reply->deleteLater();
-                manager->deleteLater();
-            });
-            manager->get(QNetworkRequest(QUrl(faviconUrl)));
-        }
-    }
+    m_favoritesModel->updateFavorite(id, newTitle, newUrl);
+    if (m_favoritesModel->tree().parentId(id) != parentId)
+        m_favoritesModel->moveFavorite(id, parentId);
+    return true;
 }
 
 
-
-QString BrowserWindow::saveFavicon(const QByteArray &data, const QUrl &url)
+void BrowserWindow::handleWebViewLoadFinished(const QUrl &url, const QString &title, bool ok)
 {
-    QString cachePath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
-    QDir().mkpath(cachePath);
-    
-    QString fileName = cachePath + "/" + url.host() + ".ico";
-    QFile file(fileName);
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(data);
-        file.close();
-    }
-    return fileName;
+    // Rien n'est écrit sur le disque pour une navigation privée
+    if (!ok || m_profile->isOffTheRecord())
+        return;
+    m_browser->omnibox()->recordVisit(url, title);
+    // Un seul gestionnaire pour toutes les fenêtres : /favicon.ico n'est
+    // demandé que si la page ne fournit pas d'icône
+    m_browser->faviconFetcher()->fetch(url);
 }
 
-void BrowserWindow::updateFaviconForFavorite(const QUrl &url, const QString &faviconPath)
-{
-    QFile file("src/favorites/favorites.json");
-    if (file.open(QIODevice::ReadOnly)) {
-        QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-        QJsonArray favoritesArray = doc.array();
-        file.close();
-
-        for (int i = 0; i < favoritesArray.size(); ++i) {
-            QJsonObject favorite = favoritesArray[i].toObject();
-            if (favorite["url"].toString() == url.toString()) {
-                favorite["favicon"] = faviconPath;
-                favoritesArray[i] = favorite;
-                break;
-            }
-        }
 
-        if (file.open(QIODevice::WriteOnly)) {
-            QJsonDocument saveDoc(favoritesArray);
-            file.write(saveDoc.toJson());
-            file.close();
-        }
-    }
+void BrowserWindow::showFavoritesManager() {
+    // Une vue de plus sur le modèle partagé : rien à recharger ni à réécrire
+    m_favoritesManager->show();
+    m_favoritesManager->raise();
+    m_favoritesManager->activateWindow();
+}
 
-    QIcon icon(faviconPath);
-    updateFaviconInFavoritesBar(url, icon);
 
-    loadFavoritesToBar();
+void BrowserWindow::addFavoriteToFolder(const QString &name, const QString &url, int folderId) {
+    m_favoritesModel->addFavorite(name, url, "", folderId);
 }
 
 
-void BrowserWindow::showFavoritesManager() {
-    QDialog dialog(this);
-    dialog.setWindowTitle(tr("Gestionnaire de favoris"));
-    QVBoxLayout *layout = new QVBoxLayout(&dialog);
-
-    QTreeWidget *tree = new QTreeWidget(&dialog);
-    tree->setHeaderLabels({tr("Nom"), tr("URL")});
-    populateFavoritesTree(tree, m_favoritesRoot);
+void BrowserWindow::populateFolderTree(QTreeWidget* tree, int parentId) {
+    tree->clear();
+    addFolderTreeItems(tree, nullptr, parentId);
 
-    QPushButton *addFolderButton = new QPushButton(tr("Ajouter un dossier"), &dialog);
-    connect(addFolderButton, &QPushButton::clicked, [this, tree]() {
-        bool ok;
-        QString folderName = QInputDialog::getText(this, tr("Nouveau dossier"),
-                                                   tr("Nom du dossier:"), QLineEdit::Normal, "", &ok);
-        if (ok && !folderName.isEmpty()) {
-            addFavoriteFolder(folderName);
-            populateFavoritesTree(tree, m_favoritesRoot);
-        }
+    // Une seule fois par arborescence : les dossiers non chargés sont lus
+    // quand l'utilisateur les déplie
+    if (tree->property("lazyFolders").toBool())
+        return;
+    tree->setProperty("lazyFolders", true);
+    connect(tree, &QTreeWidget::itemExpanded, this, [this](QTreeWidgetItem *item) {
+        m_favoritesModel->fetchChildren(item->data(0, Qt::UserRole).toInt());
+    });
+    connect(m_favoritesModel, &FavoritesModel::childrenLoaded, tree, [this, tree](int folderId) {
+        QTreeWidgetItem *item = findTreeItem(tree, folderId);
+        if (!item || item->childCount() > 0)
+            return;
+        item->setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicatorWhenChildless);
+        addFolderTreeItems(tree, item, folderId);
     });
-
-    layout->addWidget(tree);
-    layout->addWidget(addFolderButton);
-
-    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
-    connect(buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
-    connect(buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
-    layout->addWidget(buttonBox);
-
-    if (dialog.exec() == QDialog::Accepted) {
-        saveFavoritesFromTree(tree);
-        loadFavoritesToBar();
-    }
-}
-
-
-void BrowserWindow::addFavoriteToFolder(const QString &name, const QString &url, FavoriteItem* folder) {
-    int newId = m_database.addFavorite(name, url, "", folder ? folder->id : 0);
-    if (newId != -1) {
-        FavoriteItem* newItem = new FavoriteItem(newId, name, url, "", {}, folder);
-        folder->children.append(newItem);
-        loadFavoritesToBar();
-    }
 }
 
-
-void BrowserWindow::populateFolderTree(QTreeWidget* tree, FavoriteItem* parent) {
-    tree->clear();
-    if (!parent) parent = m_favoritesRoot;
-    
-    std::function<void(QTreeWidgetItem*, FavoriteItem*)> addItems;
-    addItems = [&](QTreeWidgetItem* parentItem, FavoriteItem* favorite) {
-        for (FavoriteItem* child : favorite->children) {
-            if (child->url.isEmpty()) {  // C'est un dossier
-                QTreeWidgetItem* item = new QTreeWidgetItem({child->title});
-                item->setData(0, Qt::UserRole, QVariant::fromValue(child));
-                if (parentItem) {
-                    parentItem->addChild(item);
-                } else {
-                    tree->addTopLevelItem(item);
-                }
-                addItems(item, child);
-            }
+void BrowserWindow::addFolderTreeItems(QTreeWidget *tree, QTreeWidgetItem *parentItem, int folderId)
+{
+    const FavoritesTree &favorites = m_favoritesModel->tree();
+    favorites.forEachChild(folderId, [&](int childId) {
+        if (!favorites.isFolder(childId))
+            return;
+        QTreeWidgetItem* item = new QTreeWidgetItem({favorites.title(childId)});
+        item->setData(0, Qt::UserRole, childId);
+        if (parentItem) {
+            parentItem->addChild(item);
+        } else {
+            tree->addTopLevelItem(item);
         }
-    };
-    
-    addItems(nullptr, parent);
+        if (m_favoritesModel->isLoaded(childId))
+            addFolderTreeItems(tree, item, childId);
+        else
+            item->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+    });
 }
 
 
 
-void BrowserWindow::saveFavoritesFromTree(QTreeWidget *tree)
+void BrowserWindow::scheduleFavoriteState()
 {
-    QFile file("src/favorites/favorites.json");
-    if (file.open(QIODevice::WriteOnly)) {
-        QJsonArray favoritesArray;
-
-        for (int i = 0; i < tree->topLevelItemCount(); ++i) {
-            auto item = tree->topLevelItem(i);
-            QJsonObject obj;
-            obj["title"] = item->text(0);
-            obj["url"] = item->text(1);
-            obj["folder"] = item->text(2); // Si vous avez des dossiers
-            favoritesArray.append(obj);
-        }
-
-        file.write(QJsonDocument(favoritesArray).toJson());
-        file.close();
-    }
+    // Déjà programmée : la mise à jour lira l'onglet courant au moment voulu
+    if (!m_favoriteStateTimer.isActive())
+        m_favoriteStateTimer.start();
 }
 
-
-void BrowserWindow::updateFavoriteIcon(const QUrl &url, bool ok)
+void BrowserWindow::updateFavoriteState()
 {
-    qDebug() << "Vérification de l'URL pour les favoris:" << url.toString() << "Chargement réussi:" << ok;
-
     WebView *view = currentTab();
-    if (!view) {
-        qWarning() << "WebView non initialisé !";
-        return;
-    }
-    if (!m_favAction) {
-        qWarning() << "m_favAction non initialisé !";
-        return;
-    }
-
-    bool isFav = isFavorite(url);
-    QColor iconColor = isFav ? Qt::blue : Qt::white; // Couleur selon l'état
-    
-    // Créez une icône avec la lettre "F" en fonction de l'état
-    QPixmap pix(16, 16);
-    pix.fill(Qt::transparent);
-    QPainter painter(&pix);
-    painter.setPen(QPen(iconColor));
-    painter.setFont(QFont("Arial", 10, QFont::Bold));
-    painter.drawText(pix.rect(), Qt::AlignCenter, "F");
-    m_favAction->setIcon(QIcon(pix));
-    // Mettre à jour le menu contextuel
-    m_favAction->setMenu(isFav ? createFavoriteContextMenu(url) : nullptr);
+    const QUrl url = view ? view->url() : QUrl();
+    const bool isFav = !url.isEmpty() && isFavorite(url);
+    m_favoriteUrl = url;
+
+    // Icône "F" selon l'état, rendue une seule fois par couleur et par écran
+    m_favAction->setIcon(IconCache::glyphIcon(u'F', isFav ? Qt::blue : Qt::white));
+    // Le même menu sert pour toutes les pages, il agit sur m_favoriteUrl
+    m_favAction->setMenu(isFav ? m_favoriteMenu : nullptr);
 }
 
-QMenu* BrowserWindow::createFavoriteContextMenu(const QUrl &url)
+QMenu* BrowserWindow::createFavoriteContextMenu()
 {
     QMenu* menu = new QMenu(this);
     QAction* editAction = menu->addAction(tr("Modifier le favori"));
     QAction* deleteAction = menu->addAction(tr("Supprimer le favori"));
 
-    connect(editAction, &QAction::triggered, this, [this, url]() {
-        if (FavoriteItem* item = findFavoriteByUrl(url))
-            editFavorite(item); // Passez l'objet FavoriteItem directement
+    connect(editAction, &QAction::triggered, this, [this]() {
+        const int id = m_favoritesModel->idForUrl(m_favoriteUrl);
+        if (id == -1)
+            return;
+        // Le favori peut se trouver dans un dossier pas encore chargé
+        m_favoritesModel->fetchFavorite(id).then(this, [this, id](bool loaded) {
+            if (loaded)
+                editFavorite(id);
+        });
     });
 
-    connect(deleteAction, &QAction::triggered, this, [this, url]() {
-        deleteFavorite(url);
+    connect(deleteAction, &QAction::triggered, this, [this]() {
+        deleteFavorite(m_favoriteUrl);
     });
 
     return menu;
@@ -1548,100 +1160,35 @@ QMenu* BrowserWindow::createFavoriteContextMenu(const QUrl &url)
 
 
 
-void BrowserWindow::updateUrlCompleter()
+void BrowserWindow::showUrlSuggestions(int query, const QList<OmniboxSuggestion> &suggestions)
 {
+    // Le moteur est partagé par toutes les fenêtres : seule la dernière
+    // requête de celle-ci compte
+    if (query != m_omniboxQuery || !m_urlLineEdit->hasFocus())
+        return;
+
     QStringList urls;
-    QFile file("src/favorites/favorites.json");
-    if (file.open(QIODevice::ReadOnly)) {
-        QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-        QJsonArray favoritesArray = doc.array();
-        file.close();
-
-        for (const QJsonValue &value : favoritesArray) {
-            QJsonObject obj = value.toObject();
-            urls << obj["url"].toString();
-        }
-    }
-    m_urlCompleter->setModel(new QStringListModel(urls, m_urlCompleter));
+    urls.reserve(suggestions.size());
+    for (const OmniboxSuggestion &suggestion : suggestions)
+        urls.append(suggestion.url);
+    m_urlCompleterModel->setStringList(urls);
+    if (urls.isEmpty())
+        m_urlCompleter->popup()->hide();
+    else
+        m_urlCompleter->complete();
 }
 
 
-FavoriteItem* BrowserWindow::getSelectedFolder(QTreeWidget* tree)
+int BrowserWindow::getSelectedFolder(QTreeWidget* tree)
 {
     QTreeWidgetItem* selectedItem = tree->currentItem();
     if (!selectedItem) {
-        return m_favoritesRoot; // Retourne le dossier racine si rien n'est sélectionné
+        return FavoritesModel::RootId; // Retourne le dossier racine si rien n'est sélectionné
     }
 
-    // Parcourir l'arborescence pour trouver le FavoriteItem correspondant
-    QTreeWidgetItem* currentItem = selectedItem;
-    QList<QString> path;
-    while (currentItem) {
-        path.prepend(currentItem->text(0));
-        currentItem = currentItem->parent();
-    }
-
-    FavoriteItem* current = m_favoritesRoot;
-    for (const QString& name : path) {
-        bool found = false;
-        for (FavoriteItem* child : current->children) {
-            if (child->title == name && child->url.isEmpty()) { // C'est un dossier
-                current = child;
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
-            return m_favoritesRoot; // Si le chemin n'existe pas, retourne le dossier racine
-        }
-    }
-
-    return current;
-}
-
-
-void BrowserWindow::updateFaviconInFavoritesBar(const QUrl &url, const QIcon &icon)
-{
-    for (QAction *action : m_favoritesBar->actions()) {
-        if (action->data().toUrl() == url) {
-            action->setIcon(icon);
-            break;
-        }
-    }
-}
-
-void BrowserWindow::loadFavoritesFromDatabase()
-{
-    delete m_favoritesRoot;
-    m_favoritesRoot = new FavoriteItem(-1, "Root", "", "", {}, nullptr);
-    
-    QVector<QMap<QString, QVariant>> favorites = m_database.getFavorites(0);
-    QHash<int, FavoriteItem*> items;
-
-    // Création des items
-    for (const auto &fav : favorites) {
-        items[fav["id"].toInt()] = new FavoriteItem(
-            fav["id"].toInt(),
-            fav["title"].toString(),
-            fav["url"].toString(),
-            fav["icon_path"].toString(),
-            {},
-            nullptr
-        );
-    }
-
-    // Construction hiérarchique
-    for (const auto &fav : favorites) {
-        int parentId = fav["parent_id"].toInt();
-        if (parentId > 0 && items.contains(parentId)) {
-            items[parentId]->children.append(items[fav["id"].toInt()]);
-            items[fav["id"].toInt()]->parent = items[parentId];
-        } else {
-            m_favoritesRoot->children.append(items[fav["id"].toInt()]);
-        }
-    }
-    
-    loadFavoritesToBar(); // Rafraîchir l'UI
+    // Les éléments de l'arborescence portent l'id du dossier
+    const int folderId = selectedItem->data(0, Qt::UserRole).toInt();
+    return m_favoritesModel->tree().isFolder(folderId) ? folderId : FavoritesModel::RootId;
 }
 
 
@@ -1660,24 +1207,6 @@ void BrowserWindow::onCommandPaletteCommandSelected(const QString &command)
 }
 
 
-FavoriteItem* BrowserWindow::findFavoriteByUrl(const QUrl& url, FavoriteItem* root)
-{
-    if (!root) root = m_favoritesRoot;
-    
-    if (root->url == url.toString()) {
-        return root;
-    }
-    
-    for (FavoriteItem* child : root->children) {
-        FavoriteItem* result = findFavoriteByUrl(url, child);
-        if (result) {
-            return result;
-        }
-    }
-    
-    return nullptr;
-}
-
 void BrowserWindow::duplicateCurrentTab()
 {
     WebView *currentView = currentTab();
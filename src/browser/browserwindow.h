@@ -7,7 +7,6 @@
 #include <QProgressBar>
 #include <QMenu>
 #include <QAction>
-#include <QJsonArray>
 #include <QNetworkReply>
 #include <QStandardPaths>
 #include <QComboBox>
@@ -17,6 +16,7 @@
 #include <QHBoxLayout>
 #include <QDialog>
 #include <QLineEdit>
+#include <QTimer>
 #include <QPainter>
 #include <QDrag>
 #include <QMimeData>
@@ -25,9 +25,12 @@
 #include "requestinterceptor.h"
 #include "database.h"
 #include "favoritesmanager.h"
-#include "favoriteitem.h"
+#include "favoritesmodel.h"
+#include "omniboxengine.h"
 
 class Browser;
+class FavoritesBar;
+class QStringListModel;
 class TabWidget;
 class WebView;
 class CommandPalette;
@@ -38,23 +41,18 @@ class BrowserWindow : public QMainWindow
     Q_OBJECT
 
 public:
+    // Sans onglet : Browser ouvre le premier ou y restaure la session
     explicit BrowserWindow(Browser *browser, QWebEngineProfile *profile,
                            bool forDevTools = false);
     QSize sizeHint() const override;
     TabWidget *tabWidget() const;
     WebView *currentTab() const;
     Browser *browser() { return m_browser; }
-    void refreshFavoriteIcon(const QUrl &url) { updateFavoriteIcon(url); }
-    void ensureFavoritesFileExists();
-    void serializeFavoriteTree(FavoriteItem* root, QJsonArray& array);
-
-    void buildFavoriteTree(const QJsonArray& array, FavoriteItem* parent);
-
+    void refreshFavoriteIcon() { scheduleFavoriteState(); }
     bool isFavorite(const QUrl &url) const;
 
 protected:
     void closeEvent(QCloseEvent *event) override;
-    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private slots:
     void handleNewWindowTriggered();
@@ -70,10 +68,7 @@ private slots:
     void handleFavActionTriggered();
     void showFavoritesManager();
     
-    void saveFavoritesFromTree(QTreeWidget *tree);
-    void populateFolderTree(QTreeWidget* tree, FavoriteItem* parent);
-    void handleFavoriteDrop(QDropEvent *event);
-    void startDrag();
+    void populateFolderTree(QTreeWidget* tree, int parentId = FavoritesModel::RootId);
     void toggleCommandWidget();
     void onCommandPaletteCommandSelected(const QString &command);
     void duplicateCurrentTab();
@@ -98,25 +93,26 @@ private:
     QAction *m_reloadAction = nullptr;
     QAction *m_stopReloadAction = nullptr;
     QCompleter *m_urlCompleter;
+    QStringListModel *m_urlCompleterModel = nullptr;
+    int m_omniboxQuery = -1; // dernière requête envoyée au moteur de suggestions
     QLineEdit *m_urlLineEdit = nullptr;
     QAction *m_favAction = nullptr;
+    QMenu *m_favoriteMenu = nullptr; // menu du bouton quand la page est un favori
+    QUrl m_favoriteUrl;              // page visée par ce menu
+    QTimer m_favoriteStateTimer;
     QString m_lastSearch;
     QMenu *m_settingsMenu = nullptr;
     QAction *m_settingsAction = nullptr;
     QToolBar *m_toolbar = nullptr;
-    QToolBar *m_favoritesBar = nullptr;
-    QAction *m_moreFavoritesAction = nullptr;
+    FavoritesBar *m_favoritesBar = nullptr;
     QMenu *m_favoritesMenu = nullptr;
-    QVector<QPair<QString, QString>> m_favorites;
-    Database m_database;
-    int m_draggedIndex = -1; // Ajoutez cette ligne
 
     FavoritesManager *m_favoritesManager;
-    FavoriteItem* m_favoritesRoot;
-    void addFavoriteToBar(FavoriteItem* item, QWidget* parent);
-    FavoriteItem* findFavoriteByUrl(const QUrl& url, FavoriteItem* root=nullptr);
-    FavoriteItem* getSelectedFolder(QTreeWidget* tree);
-    FavoriteItem* getSelectedFolderFromTree(QTreeWidget* tree);
+    FavoritesModel *m_favoritesModel = nullptr;
+    void addFolderTreeItems(QTreeWidget *tree, QTreeWidgetItem *parentItem, int folderId);
+    void setupNewFolderButton(QPushButton *button, QTreeWidget *folderTree, QDialog *dialog);
+    int getSelectedFolder(QTreeWidget* tree);
+    int getSelectedFolderFromTree(QTreeWidget* tree);
 
 
     // Fonctions
@@ -130,27 +126,22 @@ private:
     bool deleteFavorite(const QUrl& url);
     bool updateFavorite(int id, const QString &newTitle, const QString &newUrl, int parentId);
 
-    void updateFaviconInFavoritesBar(const QUrl &url, const QIcon &icon);
-    void addFavoriteToFolder(const QString &name, const QString &url, FavoriteItem* folder);
-    QMenu* createFavoriteContextMenu(const QUrl &url);
+    void addFavoriteToFolder(const QString &name, const QString &url, int folderId);
+    QMenu* createFavoriteContextMenu();
 
-    void loadFavoritesFromDatabase();
-    void loadFavoritesToBar();
     void openFavorite(const QUrl &url);
-    void saveFavorite(const QUrl &url, const QString &title);
-    void loadFavorites();
-    void loadFavoritesToBarRecursive(const QJsonArray& array, QWidget* parent);
 
     void showFavoriteContextMenu(const QPoint &pos);
-    void editFavorite(FavoriteItem* item);
-    QString saveFavicon(const QByteArray &data, const QUrl &url);
-    void updateFaviconForFavorite(const QUrl &url, const QString &faviconPath);
-    void updateFavoriteIcon(const QUrl &url, bool ok = true);
-    QTreeWidgetItem* findTreeItem(QTreeWidget* tree, FavoriteItem* target);
+    void editFavorite(int id);
+    // Les signaux de l'onglet courant arrivent par rafales : une seule mise à
+    // jour de l'état « favori » par trame
+    void scheduleFavoriteState();
+    void updateFavoriteState();
+    QTreeWidgetItem* findTreeItem(QTreeWidget* tree, int id);
 
     // Others
-    void handleWebViewLoadFinished(bool ok);
-    void updateUrlCompleter();
+    void handleWebViewLoadFinished(const QUrl &url, const QString &title, bool ok);
+    void showUrlSuggestions(int query, const QList<OmniboxSuggestion> &suggestions);
 
     // Command
     CommandPalette *m_commandPalette = nullptr;
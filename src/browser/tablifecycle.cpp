@@ -0,0 +1,175 @@
+#include "tablifecycle.h"
+#include "webview.h"
+
+#include <QFile>
+#include <QList>
+#include <QWebEnginePage>
+
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+namespace {
+
+using LifecycleState = QWebEnginePage::LifecycleState;
+
+constexpr int SweepIntervalMs = 10 * 1000;
+constexpr int DefaultFreezeDelaySecs = 5 * 60;
+constexpr int DefaultDiscardDelaySecs = 30 * 60;
+constexpr qint64 DefaultMemoryBudget = qint64(2) * 1024 * 1024 * 1024;
+// Part du temps (en %) passée par des tâches à attendre de la mémoire, sur 10 s
+constexpr double PressureThreshold = 10.0;
+// Sous pression, un onglet en arrière-plan depuis une minute est déchargé
+constexpr qint64 PressureDiscardDelayMs = 60 * 1000;
+
+// Jamais au-delà de l'état recommandé par le moteur ; vrai si la page a changé d'état
+bool lowerState(WebView *view, LifecycleState target)
+{
+    QWebEnginePage *page = view->page();
+    if (!page || target <= page->lifecycleState())
+        return false;
+    // Un onglet jamais affiché peut rester visible derrière l'onglet courant
+    // (contournement de QTBUG-61770) : une page visible reste active
+    if (view->isVisible())
+        view->hide();
+    target = qMin(target, page->recommendedState());
+    if (target <= page->lifecycleState())
+        return false;
+    page->setLifecycleState(target);
+    return true;
+}
+
+}
+
+TabLifecycleManager::TabLifecycleManager(QObject *parent)
+    : QObject(parent)
+    , m_freezeDelayMs(qint64(DefaultFreezeDelaySecs) * 1000)
+    , m_discardDelayMs(qint64(DefaultDiscardDelaySecs) * 1000)
+    , m_memoryBudget(DefaultMemoryBudget)
+{
+    m_sweepTimer.setInterval(SweepIntervalMs);
+    connect(&m_sweepTimer, &QTimer::timeout, this, &TabLifecycleManager::sweep);
+    m_sweepTimer.start();
+}
+
+void TabLifecycleManager::manage(WebView *view)
+{
+    // En arrière-plan tant que TabWidget n'en a pas fait l'onglet courant
+    m_background[view].start();
+    connect(view, &QObject::destroyed, this, [this, view]() {
+        m_background.remove(view);
+    });
+}
+
+void TabLifecycleManager::tabActivated(WebView *view)
+{
+    auto it = m_background.find(view);
+    if (it == m_background.end())
+        return;
+    it->invalidate();
+    // Une page déchargée se recharge d'elle-même en redevenant active
+    QWebEnginePage *page = view->page();
+    if (page && page->lifecycleState() != LifecycleState::Active)
+        page->setLifecycleState(LifecycleState::Active);
+}
+
+void TabLifecycleManager::tabDeactivated(WebView *view)
+{
+    auto it = m_background.find(view);
+    if (it != m_background.end())
+        it->start();
+}
+
+void TabLifecycleManager::sweep()
+{
+    const bool underPressure = memoryPressure() >= PressureThreshold;
+    for (auto it = m_background.cbegin(); it != m_background.cend(); ++it) {
+        if (!it->isValid())
+            continue;
+        const qint64 idle = it->elapsed();
+        if (idle >= m_discardDelayMs || (underPressure && idle >= PressureDiscardDelayMs))
+            lowerState(it.key(), LifecycleState::Discarded);
+        else if (idle >= m_freezeDelayMs)
+            lowerState(it.key(), LifecycleState::Frozen);
+    }
+    discardOverBudget();
+}
+
+void TabLifecycleManager::discardOverBudget()
+{
+    if (m_memoryBudget <= 0)
+        return;
+
+    // Plusieurs pages peuvent partager un même moteur de rendu
+    QHash<qint64, int> pagesByPid;
+    for (auto it = m_background.cbegin(); it != m_background.cend(); ++it) {
+        const QWebEnginePage *page = it.key()->page();
+        if (page && page->lifecycleState() != LifecycleState::Discarded && page->renderProcessPid() > 0)
+            ++pagesByPid[page->renderProcessPid()];
+    }
+    QHash<qint64, qint64> residentByPid;
+    qint64 total = 0;
+    for (auto it = pagesByPid.cbegin(); it != pagesByPid.cend(); ++it) {
+        const qint64 resident = residentBytes(it.key());
+        residentByPid.insert(it.key(), resident);
+        total += resident;
+    }
+    if (total <= m_memoryBudget)
+        return;
+
+    // Les onglets en arrière-plan depuis le plus longtemps d'abord
+    QList<std::pair<qint64, WebView*>> candidates;
+    for (auto it = m_background.cbegin(); it != m_background.cend(); ++it) {
+        if (it->isValid())
+            candidates.append({it->elapsed(), it.key()});
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const auto &a, const auto &b) {
+        return a.first > b.first;
+    });
+    for (const auto &candidate : std::as_const(candidates)) {
+        if (total <= m_memoryBudget)
+            break;
+        WebView *view = candidate.second;
+        const qint64 pid = view->page() ? view->page()->renderProcessPid() : 0;
+        if (!lowerState(view, LifecycleState::Discarded))
+            continue;
+        // La mémoire n'est rendue qu'avec la dernière page du processus
+        if (pid > 0 && --pagesByPid[pid] == 0)
+            total -= residentByPid.value(pid);
+    }
+}
+
+qint64 TabLifecycleManager::residentBytes(qint64 pid)
+{
+#ifdef Q_OS_LINUX
+    QFile file(QStringLiteral("/proc/%1/statm").arg(pid));
+    if (!file.open(QIODevice::ReadOnly))
+        return 0;
+    // taille totale, pages résidentes, …
+    const QList<QByteArray> fields = file.readLine().split(' ');
+    if (fields.size() < 2)
+        return 0;
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    Q_UNUSED(pid);
+    return 0;
+#endif
+}
+
+double TabLifecycleManager::memoryPressure()
+{
+#ifdef Q_OS_LINUX
+    // « some avg10=1.23 avg60=… » ; absent sur les noyaux sans PSI
+    QFile file(QStringLiteral("/proc/pressure/memory"));
+    if (!file.open(QIODevice::ReadOnly))
+        return -1;
+    const QList<QByteArray> fields = file.readLine().split(' ');
+    for (const QByteArray &field : fields) {
+        if (field.startsWith("avg10="))
+            return field.mid(6).toDouble();
+    }
+#endif
+    return -1;
+}
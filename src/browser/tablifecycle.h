@@ -0,0 +1,49 @@
+#ifndef TABLIFECYCLE_H
+#define TABLIFECYCLE_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+
+class WebView;
+
+// Cycle de vie des onglets en arrière-plan (QWebEnginePage::LifecycleState) :
+// gelés après quelques minutes, déchargés après plus longtemps, ou plus tôt si
+// les moteurs de rendu dépassent le budget mémoire ou si le système manque de
+// mémoire (/proc/pressure/memory). Un onglet n'est jamais poussé au-delà de
+// QWebEnginePage::recommendedState (lecture audio, outils de développement…).
+//
+// Une page déchargée garde son adresse et son historique ; elle est rechargée
+// dès que son onglet redevient courant.
+class TabLifecycleManager : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TabLifecycleManager(QObject *parent = nullptr);
+
+    void manage(WebView *view);
+    // Appelés par TabWidget quand l'onglet courant change
+    void tabActivated(WebView *view);
+    void tabDeactivated(WebView *view);
+
+    void setFreezeDelay(int secs) { m_freezeDelayMs = qint64(secs) * 1000; }
+    void setDiscardDelay(int secs) { m_discardDelayMs = qint64(secs) * 1000; }
+    // Mémoire résidente totale des moteurs de rendu ; 0 : pas de limite
+    void setMemoryBudget(qint64 bytes) { m_memoryBudget = bytes; }
+
+private:
+    void sweep();
+    void discardOverBudget();
+    static qint64 residentBytes(qint64 pid);
+    static double memoryPressure();
+
+    // Temps passé en arrière-plan ; invalide pour un onglet courant
+    QHash<WebView*, QElapsedTimer> m_background;
+    QTimer m_sweepTimer;
+    qint64 m_freezeDelayMs;
+    qint64 m_discardDelayMs;
+    qint64 m_memoryBudget;
+};
+
+#endif // TABLIFECYCLE_H
@@ -1,17 +1,32 @@
+#include "favoriteposition.h"
+#include "tablifecycle.h"
 #include "tabwidget.h"
 #include "webpage.h"
 #include "webview.h"
+#include <QBuffer>
 #include <QLabel>
 #include <QMenu>
 #include <QTabBar>
 #include <QWebEngineProfile>
 #include <QInputDialog>
+#include <QDataStream>
+#include <QWebEngineHistory>
 
 using namespace Qt::StringLiterals;
 
-TabWidget::TabWidget(QWebEngineProfile *profile, QWidget *parent)
+namespace {
+
+// Une navigation produit plusieurs signaux : l'onglet n'est écrit qu'une fois
+constexpr int SessionWriteDelayMs = 1000;
+// Nouvel onglet, duplication et fenêtre ouverte par une page coup sur coup
+constexpr int SpareViewCount = 2;
+
+}
+
+TabWidget::TabWidget(QWebEngineProfile *profile, TabLifecycleManager *lifecycle, QWidget *parent)
     : QTabWidget(parent)
     , m_profile(profile)
+    , m_lifecycle(lifecycle)
 {
     QTabBar *tabBar = this->tabBar();
     tabBar->setTabsClosable(true);
@@ -20,7 +35,10 @@ TabWidget::TabWidget(QWebEngineProfile *profile, QWidget *parent)
     tabBar->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(tabBar, &QTabBar::customContextMenuRequested, this, &TabWidget::handleContextMenuRequested);
     connect(tabBar, &QTabBar::tabCloseRequested, [this](int index) {
-        if (WebView *view = webView(index))
+        WebView *view = webView(index);
+        if (view && m_pendingTabs.contains(view))
+            closeTab(index); // pas de page à prévenir
+        else if (view)
             view->page()->triggerAction(QWebEnginePage::WebAction::RequestClose);
     });
     connect(tabBar, &QTabBar::tabBarDoubleClicked, [this](int index) {
@@ -32,6 +50,17 @@ TabWidget::TabWidget(QWebEngineProfile *profile, QWidget *parent)
     setElideMode(Qt::ElideRight);
 
     connect(this, &QTabWidget::currentChanged, this, &TabWidget::handleCurrentChanged);
+    // Après le déplacement de la page correspondante par QTabWidget
+    connect(tabBar, &QTabBar::tabMoved, this, &TabWidget::handleTabMoved);
+
+    m_sessionTimer.setSingleShot(true);
+    m_sessionTimer.setInterval(SessionWriteDelayMs);
+    connect(&m_sessionTimer, &QTimer::timeout, this, &TabWidget::flushSession);
+
+    // Un minuteur à 0 ms ne se déclenche qu'une fois la file d'événements vide
+    m_spareTimer.setSingleShot(true);
+    m_spareTimer.setInterval(0);
+    connect(&m_spareTimer, &QTimer::timeout, this, &TabWidget::fillSpareViews);
 
     if (profile->isOffTheRecord()) {
         QLabel *icon = new QLabel(this);
@@ -44,8 +73,17 @@ TabWidget::TabWidget(QWebEngineProfile *profile, QWidget *parent)
 
 void TabWidget::handleCurrentChanged(int index)
 {
+    if (m_currentView)
+        m_lifecycle->tabDeactivated(m_currentView);
+    m_currentView = webView(index);
+    if (m_currentView && m_pendingTabs.contains(m_currentView))
+        createPage(m_currentView);
+    if (m_currentView)
+        m_lifecycle->tabActivated(m_currentView);
+    if (m_session && m_sessionTabs.contains(m_currentView))
+        m_session->setCurrentTab(m_sessionWindow, m_sessionTabs.value(m_currentView).id);
     if (index != -1) {
-        WebView *view = webView(index);
+        WebView *view = m_currentView;
         if (!view->url().isEmpty())
             view->setFocus();
         emit titleChanged(view->title());
@@ -103,58 +141,91 @@ WebView *TabWidget::webView(int index) const
     return qobject_cast<WebView*>(widget(index));
 }
 
+int TabWidget::tabIndex(WebView *view)
+{
+    // widget() est un accès direct : l'indice mémorisé se vérifie en O(1) et
+    // n'est recherché qu'après un déplacement, une insertion ou une fermeture.
+    // Une vue absente a été fermée (closeTab retire sa clé) : ses derniers
+    // signaux ne la réinscrivent pas
+    auto it = m_tabIndexes.find(view);
+    if (it == m_tabIndexes.end())
+        return -1;
+    if (widget(*it) != view)
+        *it = indexOf(view);
+    return *it;
+}
+
 void TabWidget::setupView(WebView *webView)
 {
     QWebEnginePage *webPage = webView->page();
 
-    connect(webView, &QWebEngineView::titleChanged, [this, webView](const QString &title) {
-        int index = indexOf(webView);
+    // Une page déchargée garde son titre et son icône dans la barre d'onglets
+    auto discarded = [webView]() {
+        return webView->page()->lifecycleState() == QWebEnginePage::LifecycleState::Discarded;
+    };
+    connect(webView, &QWebEngineView::titleChanged, [this, webView, discarded](const QString &title) {
+        if (discarded())
+            return;
+        int index = tabIndex(webView);
         if (index != -1) {
             setTabText(index, title);
             setTabToolTip(index, title);
         }
-        if (currentIndex() == index)
+        if (webView == m_currentView)
             emit titleChanged(title);
     });
     connect(webView, &QWebEngineView::urlChanged, [this, webView](const QUrl &url) {
-        int index = indexOf(webView);
+        int index = tabIndex(webView);
         if (index != -1)
             tabBar()->setTabData(index, url);
-        if (currentIndex() == index)
+        if (webView == m_currentView)
             emit urlChanged(url);
     });
     connect(webView, &QWebEngineView::loadProgress, [this, webView](int progress) {
-        if (currentIndex() == indexOf(webView))
+        if (webView == m_currentView)
             emit loadProgress(progress);
     });
     connect(webPage, &QWebEnginePage::linkHovered, [this, webView](const QString &url) {
-        if (currentIndex() == indexOf(webView))
+        if (webView == m_currentView)
             emit linkHovered(url);
     });
-    connect(webView, &WebView::favIconChanged, [this, webView](const QIcon &icon) {
-        int index = indexOf(webView);
+    connect(webView, &WebView::favIconChanged, [this, webView, discarded](const QIcon &icon) {
+        if (discarded())
+            return;
+        int index = tabIndex(webView);
         if (index != -1)
             setTabIcon(index, icon);
-        if (currentIndex() == index)
+        if (webView == m_currentView)
             emit favIconChanged(icon);
     });
-    connect(webView, &WebView::favIconChanged, this, &TabWidget::updateFavicon);
     connect(webView, &WebView::webActionEnabledChanged, [this, webView](QWebEnginePage::WebAction action, bool enabled) {
-        if (currentIndex() ==  indexOf(webView))
+        if (webView == m_currentView)
             emit webActionEnabledChanged(action,enabled);
     });
     connect(webPage, &QWebEnginePage::windowCloseRequested, [this, webView]() {
-        int index = indexOf(webView);
         if (webView->page()->inspectedPage())
             window()->close();
-        else if (index >= 0)
+        else if (int index = tabIndex(webView); index >= 0)
             closeTab(index);
     });
     connect(webView, &WebView::devToolsRequested, this, &TabWidget::devToolsRequested);
+    connect(webView, &QWebEngineView::loadFinished, [this, webView](bool ok) {
+        emit pageLoadFinished(webView->url(), webView->title(), ok);
+    });
+    connect(webView, &QWebEngineView::iconChanged, [this, webView](const QIcon &icon) {
+        emit pageIconChanged(webView->url(), icon);
+    });
     connect(webPage, &QWebEnginePage::findTextFinished, [this, webView](const QWebEngineFindTextResult &result) {
-        if (currentIndex() == indexOf(webView))
+        if (webView == m_currentView)
             emit findTextFinished(result);
     });
+    auto journal = [this, webView]() {
+        markDirty(webView);
+    };
+    connect(webView, &QWebEngineView::urlChanged, this, journal);
+    connect(webView, &QWebEngineView::titleChanged, this, journal);
+    connect(webView, &QWebEngineView::loadFinished, this, journal);
+    connect(webView, &QWebEngineView::iconChanged, this, journal);
 }
 
 WebView *TabWidget::createTab()
@@ -166,22 +237,184 @@ WebView *TabWidget::createTab()
 
 WebView *TabWidget::createBackgroundTab()
 {
-    WebView *webView = new WebView;
-    WebPage *webPage = new WebPage(m_profile, webView);
-    webView->setPage(webPage);
-    setupView(webView);
+    WebView *webView = m_spareViews.isEmpty() ? createView() : m_spareViews.takeFirst();
+    m_lifecycle->manage(webView);
     int index = addTab(webView, tr("(Untitled)"));
+    m_tabIndexes.insert(webView, index);
+    if (m_session)
+        addSessionTab(webView, index > 0 ? m_sessionTabs.value(this->webView(index - 1)).position : QString());
     setTabIcon(index, webView->favIcon());
     // Workaround for QTBUG-61770
-    webView->resize(currentWidget()->size());
+    if (webView->size() != currentWidget()->size())
+        webView->resize(currentWidget()->size());
     webView->show();
+    if (!m_spareTimer.isActive())
+        m_spareTimer.start();
+    return webView;
+}
+
+WebView *TabWidget::createView()
+{
+    WebView *webView = new WebView(this);
+    WebPage *webPage = new WebPage(m_profile, webView);
+    webView->setPage(webPage);
+    setupView(webView);
     return webView;
 }
 
+void TabWidget::fillSpareViews()
+{
+    if (m_spareViews.size() >= SpareViewCount)
+        return;
+    // Une vue par passage : les événements en attente sont traités entre deux
+    WebView *view = createView();
+    view->hide();
+    if (QWidget *current = currentWidget())
+        view->resize(current->size());
+    m_spareViews.append(view);
+    if (m_spareViews.size() < SpareViewCount)
+        m_spareTimer.start();
+}
+
+WebView *TabWidget::createPendingTab(const SessionStore::Tab &tab)
+{
+    // Une vue sans page : ni WebPage ni moteur de rendu avant l'activation
+    WebView *view = new WebView;
+    m_pendingTabs.insert(view, tab);
+    m_sessionTabs.insert(view, {tab.id, tab.position});
+    const QString title = tab.title.isEmpty() ? tab.url.toDisplayString() : tab.title;
+    int index = addTab(view, title);
+    m_tabIndexes.insert(view, index);
+    setTabToolTip(index, title);
+    tabBar()->setTabData(index, tab.url);
+    // L'icône enregistrée avec l'onglet : aucune page ni requête à attendre
+    QPixmap icon;
+    if (!tab.icon.isEmpty() && icon.loadFromData(tab.icon, "PNG"))
+        setTabIcon(index, QIcon(icon));
+    return view;
+}
+
+void TabWidget::createPage(WebView *view)
+{
+    const SessionStore::Tab tab = m_pendingTabs.take(view);
+    WebPage *webPage = new WebPage(m_profile, view);
+    view->setPage(webPage);
+    setupView(view);
+    m_lifecycle->manage(view);
+
+    // L'historique restauré ramène aussi la page où l'onglet était resté
+    if (!tab.history.isEmpty()) {
+        QDataStream stream(tab.history);
+        stream >> *view->history();
+    }
+    if (view->history()->count() == 0 && tab.url.isValid())
+        view->setUrl(tab.url);
+}
+
+void TabWidget::setSession(SessionStore *store, int windowId)
+{
+    m_session = store;
+    m_sessionWindow = windowId;
+    // L'onglet ouvert avec la fenêtre
+    QString position;
+    for (int i = 0; i < count(); ++i) {
+        addSessionTab(webView(i), position);
+        position = m_sessionTabs.value(webView(i)).position;
+    }
+    if (m_sessionTabs.contains(m_currentView))
+        m_session->setCurrentTab(m_sessionWindow, m_sessionTabs.value(m_currentView).id);
+}
+
+void TabWidget::restoreSession(const SessionStore::Window &window)
+{
+    if (!m_session || window.tabs.isEmpty())
+        return;
+
+    // Les lignes existantes changent seulement de fenêtre : rien n'est réécrit
+    m_session->adoptWindow(window.id, m_sessionWindow);
+    // Le premier onglet ajouté deviendrait courant et créerait sa page :
+    // seul l'onglet courant de la session est activé, une fois tous ajoutés
+    QSignalBlocker blocker(this);
+    WebView *current = nullptr;
+    for (const SessionStore::Tab &tab : window.tabs) {
+        WebView *view = createPendingTab(tab);
+        if (tab.id == window.currentTab || !current)
+            current = view;
+    }
+    setCurrentWidget(current);
+    blocker.unblock();
+    handleCurrentChanged(currentIndex());
+}
+
+void TabWidget::flushSession()
+{
+    m_sessionTimer.stop();
+    if (!m_session)
+        return;
+    for (WebView *view : std::as_const(m_dirtyTabs)) {
+        QByteArray history;
+        QDataStream stream(&history, QIODevice::WriteOnly);
+        stream << *view->history();
+        // Seule l'icône de la page est gardée, pas celles du chargement ou d'une erreur
+        QByteArray icon;
+        if (!view->icon().isNull()) {
+            QBuffer buffer(&icon);
+            buffer.open(QIODevice::WriteOnly);
+            view->icon().pixmap(tabBar()->iconSize(), devicePixelRatioF()).save(&buffer, "PNG");
+        }
+        m_session->updateTab(m_sessionTabs.value(view).id, view->url(), view->title(), history, icon);
+    }
+    m_dirtyTabs.clear();
+}
+
+void TabWidget::dropSession()
+{
+    if (!m_session)
+        return;
+    m_sessionTimer.stop();
+    m_session->removeWindow(m_sessionWindow);
+    m_session = nullptr;
+    m_sessionTabs.clear();
+    m_dirtyTabs.clear();
+}
+
+void TabWidget::addSessionTab(WebView *view, const QString &before)
+{
+    SessionTab tab;
+    tab.position = FavoritePosition::after(before); // toujours ajouté en fin de barre
+    tab.id = m_session->addTab(m_sessionWindow, tab.position);
+    m_sessionTabs.insert(view, tab);
+    markDirty(view);
+}
+
+void TabWidget::markDirty(WebView *view)
+{
+    if (!m_session || !m_sessionTabs.contains(view))
+        return;
+    m_dirtyTabs.insert(view);
+    if (!m_sessionTimer.isActive())
+        m_sessionTimer.start();
+}
+
+void TabWidget::handleTabMoved(int from, int to)
+{
+    Q_UNUSED(from);
+    auto it = m_sessionTabs.find(webView(to));
+    if (!m_session || it == m_sessionTabs.end())
+        return;
+    // Une nouvelle clé entre les deux voisins : seule cette ligne change
+    const QString before = to > 0 ? m_sessionTabs.value(webView(to - 1)).position : QString();
+    const QString after = to + 1 < count() ? m_sessionTabs.value(webView(to + 1)).position : QString();
+    it->position = FavoritePosition::between(before, after);
+    m_session->moveTab(it->id, it->position);
+}
+
 void TabWidget::reloadAllTabs()
 {
-    for (int i = 0; i < count(); ++i)
-        webView(i)->reload();
+    for (int i = 0; i < count(); ++i) {
+        if (!m_pendingTabs.contains(webView(i)))
+            webView(i)->reload();
+    }
 }
 
 void TabWidget::closeOtherTabs(int index)
@@ -196,6 +429,12 @@ void TabWidget::closeTab(int index)
 {
     if (WebView *view = webView(index)) {
         bool hasFocus = view->hasFocus();
+        m_tabIndexes.remove(view);
+        m_pendingTabs.remove(view);
+        m_dirtyTabs.remove(view);
+        const SessionTab sessionTab = m_sessionTabs.take(view);
+        if (m_session && sessionTab.id != -1)
+            m_session->removeTab(sessionTab.id);
         removeTab(index);
         if (hasFocus && count() > 0)
             currentWebView()->setFocus();
@@ -208,8 +447,9 @@ void TabWidget::closeTab(int index)
 void TabWidget::cloneTab(int index)
 {
     if (WebView *view = webView(index)) {
+        const QUrl url = m_pendingTabs.contains(view) ? m_pendingTabs.value(view).url : view->url();
         WebView *tab = createTab();
-        tab->setUrl(view->url());
+        tab->setUrl(url);
     }
 }
 
@@ -247,7 +487,8 @@ void TabWidget::previousTab()
 
 void TabWidget::reloadTab(int index)
 {
-    if (WebView *view = webView(index))
+    WebView *view = webView(index);
+    if (view && !m_pendingTabs.contains(view))
         view->reload();
 }
 
@@ -285,22 +526,10 @@ void TabWidget::handleWebViewTitleChanged(const QString &title)
 {
     WebView *view = qobject_cast<WebView*>(sender());
     if (view) {
-        int index = indexOf(view);
+        int index = tabIndex(view);
         QString shortTitle = title.length() > 30 ? title.left(17) + "..." : title;
         setTabText(index, shortTitle);
         setTabToolTip(index, title);
     }
 }
 
-
-void TabWidget::updateFavicon(const QIcon &icon)
-{
-    WebView *view = qobject_cast<WebView*>(sender());
-    if (view) {
-        int index = indexOf(view);
-        if (index != -1) {
-            setTabIcon(index, icon);
-            emit favIconChanged(icon); // Pour mettre à jour la barre de favoris
-        }
-    }
-}
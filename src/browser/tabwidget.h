@@ -1,18 +1,24 @@
 #ifndef TABWIDGET_H
 #define TABWIDGET_H
 
+#include <QHash>
+#include <QSet>
 #include <QTabWidget>
 #include <QUrl>
 #include <QString>
 #include <QIcon>
 #include <QWebEngineFindTextResult>
 #include <QWebEnginePage>
+#include <QTimer>
+
+#include "sessionstore.h"
 
 
 QT_BEGIN_NAMESPACE
 class QWebEngineProfile;
 QT_END_NAMESPACE
 
+class TabLifecycleManager;
 class WebView;
 
 class TabWidget : public QTabWidget
@@ -20,11 +26,22 @@ class TabWidget : public QTabWidget
     Q_OBJECT
 
 public:
-    explicit TabWidget(QWebEngineProfile *profile, QWidget *parent = nullptr);
+    explicit TabWidget(QWebEngineProfile *profile, TabLifecycleManager *lifecycle, QWidget *parent = nullptr);
 
     WebView *currentWebView() const;
     void handleWebViewTitleChanged(const QString &title);
 
+    // Onglets de cette fenêtre tenus à jour dans la session (jamais pour une
+    // fenêtre privée)
+    void setSession(SessionStore *store, int windowId);
+    bool hasSession() const { return m_session != nullptr; }
+    // Reprend les onglets d'une fenêtre de la session précédente : seul
+    // l'onglet courant crée sa page, les autres attendent leur activation
+    void restoreSession(const SessionStore::Window &window);
+    void flushSession();
+    // La fenêtre est fermée pour de bon : ses onglets quittent la session
+    void dropSession();
+
 
 signals:
     // current tab/page signals
@@ -37,6 +54,10 @@ signals:
     void devToolsRequested(QWebEnginePage *source);
     void findTextFinished(const QWebEngineFindTextResult &result);
 
+    // any tab/page signals
+    void pageLoadFinished(const QUrl &url, const QString &title, bool ok);
+    void pageIconChanged(const QUrl &url, const QIcon &icon);
+
 public slots:
     // current tab/page slots
     void setUrl(const QUrl &url);
@@ -58,13 +79,42 @@ private slots:
     void closeOtherTabs(int index);
     void reloadAllTabs();
     void reloadTab(int index);
-    void updateFavicon(const QIcon &icon);
+    void handleTabMoved(int from, int to);
 
 private:
     WebView *webView(int index) const;
+    int tabIndex(WebView *view);
     void setupView(WebView *webView);
+    WebView *createView();
+    void fillSpareViews();
+    WebView *createPendingTab(const SessionStore::Tab &tab);
+    void createPage(WebView *view);
+    void addSessionTab(WebView *view, const QString &before);
+    void markDirty(WebView *view);
+
+    struct SessionTab
+    {
+        int id = -1;
+        QString position; // clé d'ordre, voir FavoritePosition
+    };
 
     QWebEngineProfile *m_profile;
+    TabLifecycleManager *m_lifecycle;
+    // Les signaux des vues ne comparent qu'un pointeur ; l'indice d'une vue
+    // n'est cherché que pour modifier son onglet
+    WebView *m_currentView = nullptr;
+    QHash<WebView*, int> m_tabIndexes;
+
+    SessionStore *m_session = nullptr;
+    int m_sessionWindow = -1;
+    QHash<WebView*, SessionTab> m_sessionTabs;
+    QSet<WebView*> m_dirtyTabs; // navigation pas encore écrite
+    QTimer m_sessionTimer;
+    QHash<WebView*, SessionStore::Tab> m_pendingTabs; // restaurés, encore sans page
+
+    // Vues déjà construites (page et signaux compris) pour les prochains onglets
+    QList<WebView*> m_spareViews;
+    QTimer m_spareTimer;
 };
 
 #endif // TABWIDGET_H
@@ -1,25 +1,70 @@
 #include "database.h"
+#include "favoritesimporter.h"
+#include "favoriteposition.h"
 #include <QDir>
-#include <QJsonDocument>
+#include <QFile>
 #include <QJsonArray>
+#include <QJsonDocument>
 #include <QJsonObject>
+#include <QSaveFile>
+#include <QSet>
 #include <QSqlQuery>
+#include <QSqlRecord>
+
+namespace {
+
+// Même forme que celle lue par FavoritesImporter
+QJsonArray exportFolder(const QHash<int, QVector<FavoriteRecord>> &children, int parentId, QSet<int> &visited)
+{
+    QJsonArray array;
+    for (const FavoriteRecord &record : children.value(parentId)) {
+        if (visited.contains(record.id))
+            continue; // parent_id en boucle : le sous-arbre est déjà écrit
+        visited.insert(record.id);
+
+        QJsonObject object;
+        object["title"] = record.title;
+        if (record.isFolder()) {
+            object["folder"] = true;
+            object["children"] = exportFolder(children, record.id, visited);
+        } else {
+            object["url"] = record.url;
+        }
+        array.append(object);
+    }
+    return array;
+}
 
+}
 
-Database::Database(QObject *parent) : QObject(parent) {}
 
-bool Database::initDatabase()
+Database::Database(QObject *parent)
+    : QObject(parent)
+    , m_db(QStringLiteral("favorites"))
+{
+}
+
+Database::~Database()
 {
-    m_db = QSqlDatabase::addDatabase("QSQLITE");
-    m_db.setDatabaseName(m_dbPath);
+    // Laisser le thread de travail terminer les écritures en attente : quit()
+    // seul abandonnerait les tâches encore dans sa file
+    if (m_workerThread) {
+        QMetaObject::invokeMethod(m_worker, []() {}, Qt::BlockingQueuedConnection);
+        m_workerThread->quit();
+        m_workerThread->wait();
+    }
+}
 
-    if (!m_db.open())
+bool Database::initDatabase()
+{
+    // Deux connexions (interface + thread de travail) partagent le fichier
+    if (!m_db.open(m_dbPath, "QSQLITE_BUSY_TIMEOUT=5000"))
     {
         qWarning() << "Impossible d'ouvrir la base de données : " << m_db.lastError().text();
         return false;
     }
 
-    QSqlQuery query;
+    QSqlQuery query(m_db.database());
     query.exec("CREATE TABLE IF NOT EXISTS folders ("
         "id INTEGER PRIMARY KEY AUTOINCREMENT, "
         "name TEXT NOT NULL, "
@@ -52,156 +97,784 @@ bool Database::initDatabase()
         }
     }
 
-    QSqlQuery("CREATE INDEX IF NOT EXISTS idx_parent_id ON favorites(parent_id)");
-    QSqlQuery("CREATE INDEX IF NOT EXISTS idx_url ON favorites(url)");
+    // url_key : URL normalisée, pour retrouver un favori sans charger la table
+    if (!m_db.database().record("favorites").contains("url_key")) {
+        query.exec("ALTER TABLE favorites ADD COLUMN url_key TEXT");
+        migrateUrlKeys();
+    }
+    // position : ordre persistant des favoris dans leur dossier
+    if (!m_db.database().record("favorites").contains("position")) {
+        query.exec("ALTER TABLE favorites ADD COLUMN position TEXT");
+        migratePositions();
+    }
+
+    query.exec("CREATE INDEX IF NOT EXISTS idx_parent_id ON favorites(parent_id)");
+    query.exec("CREATE INDEX IF NOT EXISTS idx_url ON favorites(url)");
+    query.exec("CREATE INDEX IF NOT EXISTS idx_url_key ON favorites(url_key)");
+    query.exec("CREATE INDEX IF NOT EXISTS idx_parent_position ON favorites(parent_id, position)");
 
+    reloadUrlIndex();
     return true;
 }
 
-bool Database::addFavorite(const QString &title, const QString &url, const QString &iconPath, int parentId)
+void Database::startWorker()
+{
+    if (m_worker)
+        return;
+
+    m_workerThread = new QThread(this);
+    m_workerThread->setObjectName("FavoritesDatabase");
+
+    m_worker = new Database;
+    m_worker->m_indexUrls = false;
+    m_worker->m_dbPath = m_dbPath;
+    m_worker->moveToThread(m_workerThread);
+    connect(m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_workerThread->start();
+
+    // La connexion SQLite doit être ouverte depuis le thread qui l'utilise ;
+    // les requêtes suivantes sont mises en file derrière celle-ci.
+    runOnWorker<bool>([](Database *worker) {
+        return worker->initDatabase();
+    }).then(this, [](bool ok) {
+        if (!ok)
+            qWarning() << "Impossible d'initialiser la base de données du thread de travail";
+    });
+    // L'index des URL est lu une fois ici, avant toute recherche : lu de
+    // façon asynchrone, un favori passerait pour nouveau en attendant et un
+    // clic sur l'étoile l'ajouterait en double. Les relectures suivantes
+    // gardent l'ancien index jusqu'à l'arrivée du nouveau.
+    if (m_indexUrls && !m_urlIndexLoaded)
+        setUrlIndex(readUrlKeys());
+}
+
+QFuture<int> Database::addFavoriteAsync(const QString &title, const QString &url, const QString &iconPath, int parentId)
+{
+    if (!m_worker)
+        return QtFuture::makeReadyValueFuture(addFavorite(title, url, iconPath, parentId));
+
+    return runOnWorker<int>([=](Database *worker) {
+        return worker->addFavorite(title, url, iconPath, parentId);
+    }).then(this, [this, url](int id) {
+        if (id != -1)
+            indexFavorite(id, url);
+        return id;
+    });
+}
+
+QFuture<bool> Database::deleteFavoriteAsync(int id)
+{
+    if (!m_worker)
+        return QtFuture::makeReadyValueFuture(deleteFavorite(id));
+
+    return runOnWorker<bool>([id](Database *worker) {
+        return worker->deleteFavorite(id);
+    }).then(this, [this, id](bool ok) {
+        if (ok)
+            unindexFavorite(id);
+        return ok;
+    });
+}
+
+QFuture<bool> Database::updateFavoriteAsync(int id, const QString &title, const QString &url)
+{
+    if (!m_worker)
+        return QtFuture::makeReadyValueFuture(updateFavorite(id, title, url));
+
+    return runOnWorker<bool>([=](Database *worker) {
+        return worker->updateFavorite(id, title, url);
+    }).then(this, [this, id, url](bool ok) {
+        if (ok) {
+            unindexFavorite(id);
+            indexFavorite(id, url);
+        }
+        return ok;
+    });
+}
+
+QFuture<QVector<FavoriteRecord>> Database::getFavoritesAsync(int parentId)
+{
+    if (!m_worker)
+        return QtFuture::makeReadyValueFuture(getFavorites(parentId));
+
+    return runOnWorker<QVector<FavoriteRecord>>([parentId](Database *worker) {
+        return worker->getFavorites(parentId);
+    });
+}
+
+QFuture<bool> Database::moveFavoriteAsync(int id, int parentId, int prevId, int nextId)
+{
+    if (!m_worker)
+        return QtFuture::makeReadyValueFuture(moveFavorite(id, parentId, prevId, nextId));
+
+    return runOnWorker<bool>([=](Database *worker) {
+        return worker->moveFavorite(id, parentId, prevId, nextId);
+    });
+}
+
+QFuture<QList<int>> Database::deleteFavoriteTreeAsync(int id)
+{
+    if (!m_worker)
+        return QtFuture::makeReadyValueFuture(deleteFavoriteTree(id));
+
+    return runOnWorker<QList<int>>([id](Database *worker) {
+        return worker->deleteFavoriteTree(id);
+    }).then(this, [this](const QList<int> &removed) {
+        for (int removedId : removed)
+            unindexFavorite(removedId);
+        return removed;
+    });
+}
+
+QFuture<QVector<FavoriteRecord>> Database::getAncestryAsync(int id)
+{
+    if (!m_worker)
+        return QtFuture::makeReadyValueFuture(getAncestry(id));
+
+    return runOnWorker<QVector<FavoriteRecord>>([id](Database *worker) {
+        return worker->getAncestry(id);
+    });
+}
+
+QFuture<bool> Database::applyWritesAsync(const QList<FavoriteWrite> &writes)
+{
+    if (!m_worker)
+        return QtFuture::makeReadyValueFuture(applyWrites(writes));
+
+    return runOnWorker<bool>([writes](Database *worker) {
+        return worker->applyWrites(writes);
+    });
+}
+
+QFuture<bool> Database::importJsonAsync(const QString &filePath)
+{
+    if (!m_worker)
+        return QtFuture::makeReadyValueFuture(migrateFromJson(filePath));
+
+    return runOnWorker<bool>([filePath](Database *worker) {
+        return worker->migrateFromJson(filePath);
+    }).then(this, [this](bool ok) {
+        // Ids attribués sur l'autre connexion : l'index est relu
+        if (ok)
+            reloadUrlIndex();
+        return ok;
+    });
+}
+
+QFuture<bool> Database::exportJsonAsync(const QString &filePath)
+{
+    if (!m_worker)
+        return QtFuture::makeReadyValueFuture(exportToJson(filePath));
+
+    return runOnWorker<bool>([filePath](Database *worker) {
+        return worker->exportToJson(filePath);
+    });
+}
+
+QFuture<QVector<FavoriteRecord>> Database::getFavoriteLinksAsync()
+{
+    if (!m_worker)
+        return QtFuture::makeReadyValueFuture(getFavoriteLinks());
+
+    return runOnWorker<QVector<FavoriteRecord>>([](Database *worker) {
+        return worker->getFavoriteLinks();
+    });
+}
+
+QFuture<bool> Database::updateFaviconAsync(int id, const QString &faviconPath)
+{
+    if (!m_worker)
+        return QtFuture::makeReadyValueFuture(updateFavicon(id, faviconPath));
+
+    return runOnWorker<bool>([=](Database *worker) {
+        return worker->updateFavicon(id, faviconPath);
+    });
+}
+
+QFuture<bool> Database::replaceIconPathsAsync(const QHash<QString, QString> &paths)
+{
+    if (!m_worker)
+        return QtFuture::makeReadyValueFuture(replaceIconPaths(paths));
+
+    return runOnWorker<bool>([paths](Database *worker) {
+        return worker->replaceIconPaths(paths);
+    });
+}
+
+FavoriteRecord Database::recordFromQuery(const QSqlQuery &query)
+{
+    // Colonnes attendues : id, title, url, icon_path, parent_id, position
+    FavoriteRecord record;
+    record.id = query.value(0).toInt();
+    record.title = query.value(1).toString();
+    record.url = query.value(2).toString();
+    record.iconPath = query.value(3).toString();
+    record.parentId = query.value(4).toInt();
+    record.position = query.value(5).toString();
+    return record;
+}
+
+QString Database::normalizeUrl(const QUrl &url)
+{
+    if (url.isEmpty())
+        return QString();
+    return url.adjusted(QUrl::NormalizePathSegments | QUrl::StripTrailingSlash)
+              .toString(QUrl::FullyEncoded);
+}
+
+void Database::migrateUrlKeys()
+{
+    // Une seule fois, à l'ajout de la colonne : les écritures suivantes la renseignent
+    QSqlQuery select(m_db.database());
+    select.setForwardOnly(true);
+    if (!select.exec("SELECT id, url FROM favorites WHERE url <> ''"))
+        return;
+
+    m_db.transaction();
+    QSqlQuery update(m_db.database());
+    update.prepare("UPDATE favorites SET url_key = ? WHERE id = ?");
+    while (select.next()) {
+        update.bindValue(0, normalizeUrl(QUrl(select.value(1).toString())));
+        update.bindValue(1, select.value(0).toInt());
+        update.exec();
+    }
+    m_db.commit();
+}
+
+void Database::migratePositions()
+{
+    // Une seule fois : l'ordre d'insertion devient l'ordre persistant
+    QSqlQuery select(m_db.database());
+    select.setForwardOnly(true);
+    if (!select.exec("SELECT id, parent_id FROM favorites ORDER BY parent_id, id"))
+        return;
+
+    QVector<QPair<int, int>> rows; // (parent_id, id)
+    while (select.next())
+        rows.append({select.value(1).toInt(), select.value(0).toInt()});
+    select.finish();
+
+    m_db.transaction();
+    QSqlQuery update(m_db.database());
+    update.prepare("UPDATE favorites SET position = ? WHERE id = ?");
+    for (qsizetype begin = 0; begin < rows.size();) {
+        qsizetype end = begin;
+        while (end < rows.size() && rows[end].first == rows[begin].first)
+            ++end;
+        const QStringList keys = FavoritePosition::sequence(QString(), end - begin);
+        for (qsizetype i = begin; i < end; ++i) {
+            update.bindValue(0, keys[i - begin]);
+            update.bindValue(1, rows[i].second);
+            update.exec();
+        }
+        begin = end;
+    }
+    m_db.commit();
+}
+
+QString Database::positionOf(int id) const
+{
+    QSqlQuery &query = m_db.preparedQuery("SELECT position FROM favorites WHERE id = ?");
+    query.bindValue(0, id);
+    QString position;
+    if (query.exec() && query.next())
+        position = query.value(0).toString();
+    query.finish();
+    return position;
+}
+
+QString Database::lastPosition(int parentId, int excludedId) const
+{
+    // Servi par idx_parent_position sans parcourir le dossier
+    QSqlQuery &query = m_db.preparedQuery("SELECT MAX(position) FROM favorites WHERE parent_id = ? AND id <> ?");
+    query.bindValue(0, parentId);
+    query.bindValue(1, excludedId);
+    QString position;
+    if (query.exec() && query.next())
+        position = query.value(0).toString();
+    query.finish();
+    return position;
+}
+
+void Database::rebalancePositions(int parentId)
+{
+    // Seulement si deux clés se confondent (données anciennes ou importées) :
+    // le dossier est renuméroté dans son ordre actuel
+    QSqlQuery &select = m_db.preparedQuery("SELECT id FROM favorites WHERE parent_id = ? ORDER BY position, id");
+    select.bindValue(0, parentId);
+    QList<int> ids;
+    if (select.exec()) {
+        while (select.next())
+            ids.append(select.value(0).toInt());
+    }
+    select.finish();
+
+    const QStringList keys = FavoritePosition::sequence(QString(), ids.size());
+    QSqlQuery &update = m_db.preparedQuery("UPDATE favorites SET position = ? WHERE id = ?");
+    for (qsizetype i = 0; i < ids.size(); ++i) {
+        update.bindValue(0, keys[i]);
+        update.bindValue(1, ids[i]);
+        update.exec();
+    }
+    update.finish();
+}
+
+QHash<int, QString> Database::readUrlKeys() const
+{
+    // Quelques octets par favori : toute la table tient en mémoire
+    QHash<int, QString> keys;
+    QSqlQuery &query = m_db.preparedQuery("SELECT id, url_key FROM favorites WHERE url_key <> ''");
+    if (query.exec()) {
+        while (query.next())
+            keys.insert(query.value(0).toInt(), query.value(1).toString());
+    }
+    query.finish();
+    return keys;
+}
+
+void Database::setUrlIndex(const QHash<int, QString> &keys)
+{
+    m_urlById = keys;
+    m_idsByUrl.clear();
+    m_idsByUrl.reserve(keys.size());
+    for (auto it = keys.cbegin(); it != keys.cend(); ++it)
+        m_idsByUrl[it.value()].append(it.key());
+    m_urlIndexLoaded = true;
+}
+
+void Database::reloadUrlIndex()
+{
+    if (!m_indexUrls)
+        return;
+
+    if (!m_worker) {
+        // Sans thread de travail, relu à la première recherche
+        m_idsByUrl.clear();
+        m_urlById.clear();
+        m_urlIndexLoaded = false;
+        return;
+    }
+    // Lu derrière les écritures déjà en file, dont les réponses arrivent
+    // avant la sienne ; celles qui suivent mettront l'index à jour après
+    runOnWorker<QHash<int, QString>>([](Database *worker) {
+        return worker->readUrlKeys();
+    }).then(this, [this](const QHash<int, QString> &keys) {
+        setUrlIndex(keys);
+    });
+}
+
+void Database::indexFavorite(int id, const QString &url)
+{
+    if (!m_indexUrls)
+        return;
+
+    const QString key = normalizeUrl(QUrl(url));
+    if (key.isEmpty())
+        return;
+    QList<int> &ids = m_idsByUrl[key];
+    if (!ids.contains(id))
+        ids.append(id);
+    m_urlById.insert(id, key);
+}
+
+void Database::unindexFavorite(int id)
+{
+    const QString key = m_urlById.take(id);
+    auto it = m_idsByUrl.find(key);
+    if (it == m_idsByUrl.end())
+        return;
+    it->removeAll(id);
+    if (it->isEmpty())
+        m_idsByUrl.erase(it);
+}
+
+bool Database::isFavoriteUrl(const QUrl &url) const
+{
+    return favoriteIdForUrl(url) != -1;
+}
+
+int Database::favoriteIdForUrl(const QUrl &url) const
+{
+    const QString key = normalizeUrl(url);
+    if (key.isEmpty())
+        return -1;
+
+    // Avec un thread de travail, l'index est lu par startWorker ; sans lui,
+    // il est lu ici une fois
+    if (!m_urlIndexLoaded)
+        const_cast<Database *>(this)->setUrlIndex(readUrlKeys());
+
+    auto it = m_idsByUrl.constFind(key);
+    return it == m_idsByUrl.constEnd() || it->isEmpty() ? -1 : it->first();
+}
+
+int Database::addFavorite(const QString &title, const QString &url, const QString &iconPath, int parentId)
 {
-    QSqlQuery query;
-    query.prepare("INSERT INTO favorites (title, url, icon_path, parent_id) "
-                  "VALUES (:title, :url, :icon_path, :parent_id)");
-    query.bindValue(":title", title);
-    query.bindValue(":url", url);
+    // Nouveau favori en fin de dossier
+    const QString position = FavoritePosition::after(lastPosition(parentId));
+
+    QSqlQuery &query = m_db.preparedQuery("INSERT INTO favorites (title, url, icon_path, parent_id, url_key, position) "
+                                     "VALUES (:title, :url, :icon_path, :parent_id, :url_key, :position)");
+    // Une QString nulle serait liée comme NULL, refusé par les colonnes NOT NULL
+    query.bindValue(":title", title.isNull() ? QStringLiteral("") : title);
+    query.bindValue(":url", url.isNull() ? QStringLiteral("") : url);
     query.bindValue(":icon_path", iconPath);
     query.bindValue(":parent_id", parentId);
+    query.bindValue(":url_key", normalizeUrl(QUrl(url)));
+    query.bindValue(":position", position);
+
+    if (!query.exec())
+        return -1;
 
-    return query.exec();
+    const int id = query.lastInsertId().toInt();
+    query.finish();
+    indexFavorite(id, url);
+    return id;
 }
 
 
 bool Database::deleteFavorite(int id)
 {
-    QSqlQuery query;
-    query.prepare("DELETE FROM favorites WHERE id = :id");
+    QSqlQuery &query = m_db.preparedQuery("DELETE FROM favorites WHERE id = :id");
     query.bindValue(":id", id);
-    return query.exec();
+    if (!query.exec())
+        return false;
+
+    query.finish();
+    unindexFavorite(id);
+    return true;
 }
 
-QVector<QMap<QString, QVariant>> Database::getFavorites(int parentId)
+QVector<FavoriteRecord> Database::getFavorites(int parentId)
+{
+    // Un seul niveau, via idx_parent_id : parentId = 0 donne la racine
+    QVector<FavoriteRecord> results;
+    QSqlQuery &query = m_db.preparedQuery("SELECT id, title, url, icon_path, parent_id, position FROM favorites "
+                                     "WHERE parent_id = :parent_id ORDER BY position, id");
+    query.bindValue(":parent_id", parentId);
 
+    if (query.exec()) {
+        while (query.next())
+            results.append(recordFromQuery(query));
+        query.finish();
+    }
+    return results;
+}
+
+QList<int> Database::deleteFavoriteTree(int id)
 {
-    QVector<QMap<QString, QVariant>> results;
-    QSqlQuery query;
-    
-    if(parentId == 0) {
-        query.prepare("SELECT id, title, url, icon_path, parent_id FROM favorites");
-    } else {
-        query.prepare("SELECT id, title, url, icon_path, parent_id FROM favorites WHERE parent_id = :parent_id");
-        query.bindValue(":parent_id", parentId);
+    // Le favori et tous ses descendants, en une transaction
+    QList<int> removed;
+    if (!m_db.transaction())
+        return removed;
+
+    QSqlQuery &select = m_db.preparedQuery("WITH RECURSIVE subtree(id) AS ("
+                                      "SELECT ? UNION "
+                                      "SELECT f.id FROM favorites f JOIN subtree s ON f.parent_id = s.id) "
+                                      "SELECT id FROM subtree");
+    select.bindValue(0, id);
+    if (select.exec()) {
+        while (select.next())
+            removed.append(select.value(0).toInt());
     }
-    
-    if(query.exec()) {
-        while(query.next()) {
-            QMap<QString, QVariant> row;
-            row["id"] = query.value(0);
-            row["title"] = query.value(1);
-            row["url"] = query.value(2);
-            row["icon_path"] = query.value(3);
-            row["parent_id"] = query.value(4);
-            results.append(row);
-        }
+    select.finish();
+
+    QSqlQuery &remove = m_db.preparedQuery("WITH RECURSIVE subtree(id) AS ("
+                                      "SELECT ? UNION "
+                                      "SELECT f.id FROM favorites f JOIN subtree s ON f.parent_id = s.id) "
+                                      "DELETE FROM favorites WHERE id IN subtree");
+    remove.bindValue(0, id);
+    if (!remove.exec() || !m_db.commit()) {
+        qWarning() << "Impossible de supprimer le favori" << id << remove.lastError().text();
+        remove.finish();
+        m_db.rollback();
+        return {};
+    }
+    remove.finish();
+
+    for (int removedId : std::as_const(removed))
+        unindexFavorite(removedId);
+    return removed;
+}
+
+QVector<FavoriteRecord> Database::getAncestry(int id)
+{
+    // Le favori et ses dossiers parents, de la racine vers le favori
+    QVector<FavoriteRecord> results;
+    QSqlQuery &query = m_db.preparedQuery("WITH RECURSIVE chain(id, title, url, icon_path, parent_id, position, depth) AS ("
+                                     "SELECT id, title, url, icon_path, parent_id, position, 0 FROM favorites WHERE id = ? "
+                                     "UNION ALL "
+                                     "SELECT f.id, f.title, f.url, f.icon_path, f.parent_id, f.position, c.depth + 1 "
+                                     "FROM favorites f JOIN chain c ON f.id = c.parent_id WHERE c.depth < 256) "
+                                     "SELECT id, title, url, icon_path, parent_id, position FROM chain ORDER BY depth DESC");
+    query.bindValue(0, id);
+
+    if (query.exec()) {
+        while (query.next())
+            results.append(recordFromQuery(query));
+        query.finish();
     }
     return results;
 }
 
+QVector<FavoriteRecord> Database::getFavoriteLinks()
+{
+    QVector<FavoriteRecord> records;
+    QSqlQuery &query = m_db.preparedQuery("SELECT id, title, url, icon_path, parent_id, position FROM favorites "
+                                          "WHERE url <> ''");
+    if (query.exec()) {
+        while (query.next())
+            records.append(recordFromQuery(query));
+        query.finish();
+    }
+    return records;
+}
+
 bool Database::updateFavicon(int id, const QString& faviconPath)
 {
-    QSqlQuery query;
-    query.prepare("UPDATE favorites SET icon_path = :path WHERE id = :id");
+    QSqlQuery &query = m_db.preparedQuery("UPDATE favorites SET icon_path = :path WHERE id = :id");
     query.bindValue(":path", faviconPath);
     query.bindValue(":id", id);
-    return query.exec();
+    const bool ok = query.exec();
+    query.finish();
+    return ok;
 }
 
-
-
-QMap<QString, QVariant> Database::getFavoriteByUrl(const QUrl& url) const
+bool Database::replaceIconPaths(const QHash<QString, QString> &paths)
 {
-    QSqlQuery query;
-    query.prepare("SELECT id, title, icon_path, parent_id FROM favorites WHERE url = :url");
-    query.bindValue(":url", url.toString());
-    
-    if(query.exec() && query.next()) {
-        return {
-            {"id", query.value(0)},
-            {"title", query.value(1)},
-            {"icon_path", query.value(2)},
-            {"parent_id", query.value(3)}
-        };
+    if (paths.isEmpty())
+        return true;
+
+    if (!m_db.transaction()) {
+        qWarning() << "Impossible d'ouvrir la transaction :" << m_db.lastError().text();
+        return false;
+    }
+    // Un seul parcours des favoris, quel que soit le nombre de chemins
+    QHash<int, QString> replaced;
+    QSqlQuery &select = m_db.preparedQuery("SELECT id, icon_path FROM favorites WHERE icon_path IS NOT NULL");
+    if (select.exec()) {
+        while (select.next()) {
+            auto it = paths.constFind(select.value(1).toString());
+            if (it != paths.cend())
+                replaced.insert(select.value(0).toInt(), it.value());
+        }
+    }
+    select.finish();
+
+    QSqlQuery &query = m_db.preparedQuery("UPDATE favorites SET icon_path = ? WHERE id = ?");
+    for (auto it = replaced.cbegin(); it != replaced.cend(); ++it) {
+        query.bindValue(0, it.value());
+        query.bindValue(1, it.key());
+        if (!query.exec()) {
+            qWarning() << "Échec du remplacement de l'icône du favori" << it.key() << query.lastError().text();
+            query.finish();
+            m_db.rollback();
+            return false;
+        }
     }
-    return {};
+    query.finish();
+    return m_db.commit();
 }
 
 
-bool Database::updateFavorite(int id, const QString &newTitle, const QString &newUrl, int parentId)
+
+FavoriteRecord Database::getFavoriteByUrl(const QUrl& url) const
 {
-    QSqlQuery query;
-    query.prepare("UPDATE favorites SET title = ?, url = ?, parent_id = ? WHERE id = ?");
-    query.addBindValue(newTitle);
-    query.addBindValue(newUrl);
-    query.addBindValue(parentId);
-    query.addBindValue(id);
-    return query.exec();
+    // L'index évite un aller-retour SQLite pour les URL qui ne sont pas en favoris
+    const int id = favoriteIdForUrl(url);
+    if (id == -1)
+        return {};
+
+    QSqlQuery &query = m_db.preparedQuery("SELECT id, title, url, icon_path, parent_id, position FROM favorites WHERE id = :id");
+    query.bindValue(":id", id);
+
+    FavoriteRecord record;
+    if (query.exec() && query.next())
+        record = recordFromQuery(query);
+    query.finish();
+    return record;
 }
 
 
-bool Database::migrateFromJson()
+bool Database::updateFavorite(int id, const QString &newTitle, const QString &newUrl)
 {
-    QFile file("src/favorites/favorites.json");
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Impossible d'ouvrir le fichier JSON des favoris";
+    QSqlQuery &query = m_db.preparedQuery("UPDATE favorites SET title = ?, url = ?, url_key = ? WHERE id = ?");
+    query.bindValue(0, newTitle.isNull() ? QStringLiteral("") : newTitle);
+    query.bindValue(1, newUrl.isNull() ? QStringLiteral("") : newUrl);
+    query.bindValue(2, normalizeUrl(QUrl(newUrl)));
+    query.bindValue(3, id);
+    if (!query.exec())
         return false;
+
+    query.finish();
+    unindexFavorite(id);
+    indexFavorite(id, newUrl);
+    return true;
+}
+
+
+bool Database::moveFavorite(int id, int parentId, int prevId, int nextId)
+{
+    QString before;
+    QString after;
+    if (prevId == -1 && nextId == -1) {
+        before = lastPosition(parentId, id);
+    } else {
+        if (prevId != -1)
+            before = positionOf(prevId);
+        if (nextId != -1)
+            after = positionOf(nextId);
+        if (!after.isEmpty() && before >= after) {
+            rebalancePositions(parentId);
+            before = prevId != -1 ? positionOf(prevId) : QString();
+            after = positionOf(nextId);
+        }
     }
 
-    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-    file.close();
+    QSqlQuery &query = m_db.preparedQuery("UPDATE favorites SET parent_id = ?, position = ? WHERE id = ?");
+    query.bindValue(0, parentId);
+    query.bindValue(1, FavoritePosition::between(before, after));
+    query.bindValue(2, id);
+    const bool ok = query.exec();
+    query.finish();
+    return ok;
+}
+
+int Database::nextFavoriteId() const
+{
+    QSqlQuery &query = m_db.preparedQuery("SELECT COALESCE(MAX(id), 0) + 1 FROM favorites");
+    int id = 1;
+    if (query.exec() && query.next())
+        id = query.value(0).toInt();
+    query.finish();
+    return id;
+}
+
+bool Database::addFavorites(QSpan<const FavoriteRecord> records)
+{
+    if (records.empty())
+        return true;
 
-    if (!doc.isArray()) {
-        qWarning() << "Le fichier JSON des favoris n'est pas un tableau";
+    if (!m_db.transaction()) {
+        qWarning() << "Impossible d'ouvrir la transaction :" << m_db.lastError().text();
         return false;
     }
 
-    QJsonArray favoritesArray = doc.array();
+    // Clés d'ordre régulièrement espacées, à la suite de chaque dossier
+    QHash<int, qsizetype> counts;
+    for (const FavoriteRecord &record : records)
+        ++counts[record.parentId];
+    QHash<int, QStringList> positions;
+    for (auto it = counts.cbegin(); it != counts.cend(); ++it)
+        positions.insert(it.key(), FavoritePosition::sequence(lastPosition(it.key()), it.value()));
+    QHash<int, qsizetype> used;
+
+    QSqlQuery &query = m_db.preparedQuery("INSERT INTO favorites (id, title, url, icon_path, parent_id, url_key, position) "
+                                     "VALUES (?, ?, ?, ?, ?, ?, ?)");
+    for (const FavoriteRecord &record : records) {
+        // Un id NULL laisse SQLite l'attribuer
+        query.bindValue(0, record.id > 0 ? QVariant(record.id) : QVariant(QMetaType(QMetaType::Int)));
+        query.bindValue(1, record.title);
+        query.bindValue(2, record.url);
+        query.bindValue(3, record.iconPath);
+        query.bindValue(4, record.parentId);
+        query.bindValue(5, normalizeUrl(QUrl(record.url)));
+        query.bindValue(6, record.position.isEmpty()
+                               ? positions[record.parentId].at(used[record.parentId]++)
+                               : record.position);
+        if (!query.exec()) {
+            qWarning() << "Échec de l'insertion du favori" << record.title << query.lastError().text();
+            query.finish();
+            m_db.rollback();
+            return false;
+        }
+    }
+    query.finish();
 
-    m_db.transaction();
+    if (!m_db.commit()) {
+        qWarning() << "Impossible de valider la transaction :" << m_db.lastError().text();
+        m_db.rollback();
+        return false;
+    }
 
-    for (const QJsonValue &value : favoritesArray) {
-        QJsonObject obj = value.toObject();
-        QString title = obj["title"].toString();
-        QString url = obj["url"].toString();
-        QString iconPath = obj["favicon"].toString();
-        int parentId = obj["folder"].toBool() ? 0 : obj["parent_id"].toInt(0);
+    // Les ids attribués par SQLite ne sont pas connus ici : l'index est relu
+    reloadUrlIndex();
+    return true;
+}
 
-        if (!addFavorite(title, url, iconPath, parentId)) {
+bool Database::applyWrites(const QList<FavoriteWrite> &writes)
+{
+    if (writes.isEmpty())
+        return true;
+
+    // Une seule synchronisation sur le disque pour tout le lot
+    if (!m_db.transaction()) {
+        qWarning() << "Impossible d'ouvrir la transaction :" << m_db.lastError().text();
+        return false;
+    }
+    for (const FavoriteWrite &write : writes) {
+        const bool ok = write.kind == FavoriteWrite::Move
+                            ? moveFavorite(write.id, write.parentId, write.prevId, write.nextId)
+                            : updateFavicon(write.id, write.iconPath);
+        if (!ok) {
+            qWarning() << "Échec de l'écriture différée du favori" << write.id << m_db.lastError().text();
             m_db.rollback();
-            qWarning() << "Échec de la migration : impossible d'ajouter le favori" << title;
             return false;
         }
+    }
+    if (!m_db.commit()) {
+        qWarning() << "Impossible de valider la transaction :" << m_db.lastError().text();
+        m_db.rollback();
+        return false;
+    }
+    return true;
+}
 
-        if (obj.contains("children")) {
-            QJsonArray children = obj["children"].toArray();
-            for (const QJsonValue &childValue : children) {
-                QJsonObject childObj = childValue.toObject();
-                QString childTitle = childObj["title"].toString();
-                QString childUrl = childObj["url"].toString();
-                QString childIconPath = childObj["favicon"].toString();
-
-                if (!addFavorite(childTitle, childUrl, childIconPath, parentId)) {
-                    m_db.rollback();
-                    qWarning() << "Échec de la migration : impossible d'ajouter le favori enfant" << childTitle;
-                    return false;
-                }
-            }
-        }
+bool Database::exportToJson(const QString &filePath)
+{
+    // Toute la table en une requête, regroupée par dossier dans l'ordre des frères
+    QHash<int, QVector<FavoriteRecord>> children;
+    QSqlQuery &query = m_db.preparedQuery("SELECT id, title, url, icon_path, parent_id, position FROM favorites "
+                                     "ORDER BY parent_id, position, id");
+    if (!query.exec()) {
+        qWarning() << "Impossible de lire les favoris à exporter :" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        const FavoriteRecord record = recordFromQuery(query);
+        children[record.parentId].append(record);
     }
+    query.finish();
 
-    if (!m_db.commit()) {
-        qWarning() << "Échec de la migration : impossible de valider la transaction";
+    QSet<int> visited;
+    const QByteArray json = QJsonDocument(exportFolder(children, 0, visited)).toJson();
+
+    // Remplacement atomique : un fichier existant reste intact en cas d'échec
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit()) {
+        qWarning() << "Impossible d'écrire" << filePath << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool Database::migrateFromJson(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Impossible d'ouvrir le fichier JSON des favoris";
         return false;
     }
 
+    FavoritesImporter importer(nextFavoriteId());
+    if (!importer.read(&file)) {
+        qWarning() << "Le fichier JSON des favoris est invalide :" << importer.errorString();
+        return false;
+    }
+
+    if (!addFavorites(importer.records())) {
+        qWarning() << "Échec de la migration des favoris";
+        return false;
+    }
     return true;
-}
\ No newline at end of file
+}
@@ -3,31 +3,127 @@
 
 #include <QUrl>
 #include <QObject>
-#include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QStandardPaths>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QVector>
+#include <QThread>
+#include <QFuture>
+#include <QPromise>
+#include <QSpan>
+
+#include <memory>
+
+#include "favoriterecord.h"
+#include "favoritewrite.h"
+#include "sqliteconnection.h"
 
 class Database : public QObject
 {
     Q_OBJECT
 public:
     explicit Database(QObject *parent = nullptr);
+    ~Database();
     bool initDatabase();
-    bool migrateFromJson();
+    // Le JSON n'est qu'un format d'échange : les favoris vivent dans la base
+    bool migrateFromJson(const QString &filePath = "src/favorites/favorites.json");
+    bool exportToJson(const QString &filePath);
     bool updateFavicon(int id, const QString& faviconPath);
-    QMap<QString, QVariant> getFavoriteByUrl(const QUrl& url) const;
+    // Ancien chemin d'icône -> nouveau, pour tous les favoris, en une transaction
+    bool replaceIconPaths(const QHash<QString, QString> &paths);
+    FavoriteRecord getFavoriteByUrl(const QUrl& url) const;
+
+    // Index complet URL normalisée -> ids, tenu en mémoire : une recherche ne
+    // touche jamais la base. Il est lu d'un seul parcours au démarrage du
+    // thread de travail, puis tenu à jour par les opérations CRUD.
+    bool isFavoriteUrl(const QUrl &url) const;
+    int favoriteIdForUrl(const QUrl &url) const;
+    static QString normalizeUrl(const QUrl &url);
 
-    
     // Opération CRUD
-    bool addFavorite(const QString &title, const QString &url, const QString &iconPath, int parentId = 0);
+    int addFavorite(const QString &title, const QString &url, const QString &iconPath, int parentId = 0);
     bool deleteFavorite(int id);
-    bool updateFavorite(int id, const QString &title, const QString &url, int parentId);
-    QVector<QMap<QString, QVariant>> getFavorites(int parentId);
+    // Titre et URL seulement : changer de dossier passe par moveFavorite,
+    // qui donne au favori une place parmi ses nouveaux frères
+    bool updateFavorite(int id, const QString &title, const QString &url);
+    QVector<FavoriteRecord> getFavorites(int parentId);
+
+    // Place le favori dans parentId entre les frères prevId et nextId (-1 :
+    // aucun ; les deux à -1 : en fin de dossier). Une seule ligne est écrite.
+    bool moveFavorite(int id, int parentId, int prevId, int nextId);
+
+    // Sous-arbres par requêtes récursives (CTE) sur parent_id
+    QList<int> deleteFavoriteTree(int id);
+    QVector<FavoriteRecord> getAncestry(int id);
+    // Tous les favoris qui ont une adresse, dossiers exclus, sans ordre
+    QVector<FavoriteRecord> getFavoriteLinks();
+
+    // Insertion en masse : une seule requête préparée, une seule transaction.
+    // Les enregistrements dont l'id est renseigné gardent cet id.
+    bool addFavorites(QSpan<const FavoriteRecord> records);
+    // Écritures différées, appliquées dans l'ordre : tout ou rien
+    bool applyWrites(const QList<FavoriteWrite> &writes);
+    int nextFavoriteId() const;
+
+    // Mode asynchrone : une seconde connexion vit sur un thread dédié et
+    // exécute les requêtes dans l'ordre d'appel, sans bloquer l'interface.
+    void startWorker();
+    bool hasWorker() const { return m_worker != nullptr; }
+    QFuture<int> addFavoriteAsync(const QString &title, const QString &url, const QString &iconPath, int parentId = 0);
+    QFuture<bool> deleteFavoriteAsync(int id);
+    QFuture<bool> updateFavoriteAsync(int id, const QString &title, const QString &url);
+    QFuture<bool> moveFavoriteAsync(int id, int parentId, int prevId, int nextId);
+    QFuture<QVector<FavoriteRecord>> getFavoritesAsync(int parentId);
+    QFuture<QList<int>> deleteFavoriteTreeAsync(int id);
+    QFuture<QVector<FavoriteRecord>> getAncestryAsync(int id);
+    QFuture<QVector<FavoriteRecord>> getFavoriteLinksAsync();
+    QFuture<bool> updateFaviconAsync(int id, const QString &faviconPath);
+    QFuture<bool> replaceIconPathsAsync(const QHash<QString, QString> &paths);
+    QFuture<bool> applyWritesAsync(const QList<FavoriteWrite> &writes);
+    QFuture<bool> importJsonAsync(const QString &filePath);
+    QFuture<bool> exportJsonAsync(const QString &filePath);
 
 private:
-    QSqlDatabase m_db;
+    template <typename T, typename Job>
+    QFuture<T> runOnWorker(Job job);
+
+    static FavoriteRecord recordFromQuery(const QSqlQuery &query);
+
+    void migrateUrlKeys();
+    void migratePositions();
+    QString positionOf(int id) const;
+    QString lastPosition(int parentId, int excludedId = -1) const;
+    void rebalancePositions(int parentId);
+    QHash<int, QString> readUrlKeys() const;
+    void setUrlIndex(const QHash<int, QString> &keys);
+    void reloadUrlIndex();
+    void indexFavorite(int id, const QString &url);
+    void unindexFavorite(int id);
+
+    SqliteConnection m_db;
+    QHash<QString, QList<int>> m_idsByUrl;
+    QHash<int, QString> m_urlById;
+    bool m_urlIndexLoaded = false;
+    bool m_indexUrls = true;
+    QThread *m_workerThread = nullptr;
+    Database *m_worker = nullptr;
     QString m_dbPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/favorites.db";
 };
 
+template <typename T, typename Job>
+QFuture<T> Database::runOnWorker(Job job)
+{
+    auto promise = std::make_shared<QPromise<T>>();
+    QFuture<T> future = promise->future();
+    promise->start();
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, promise, job]() {
+        promise->addResult(job(worker));
+        promise->finish();
+    }, Qt::QueuedConnection);
+    return future;
+}
+
 #endif // DATABASE_H
\ No newline at end of file
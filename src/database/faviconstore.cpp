@@ -0,0 +1,418 @@
+#include "faviconstore.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QSqlError>
+#include <QTimeZone>
+
+#include <utility>
+
+namespace {
+
+const QString ReferencePrefix = QStringLiteral("favicon:");
+// Quelques milliers de favicons : largement assez pour les sites visités
+constexpr qint64 DefaultByteBudget = 8 * 1024 * 1024;
+// Une éviction descend un peu sous le budget pour ne pas recommencer à chaque ajout
+constexpr int EvictionTargetPercent = 90;
+// Dates d'utilisation regroupées en une écriture
+constexpr int UsageFlushDelayMs = 60 * 1000;
+// Paramètres liés par requête IN, sous la limite de SQLite
+constexpr qsizetype MaxBoundHashes = 256;
+
+QByteArray contentHash(const QByteArray &data)
+{
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+QString placeholders(qsizetype count)
+{
+    QString list;
+    list.reserve(count * 2);
+    for (qsizetype i = 0; i < count; ++i)
+        list += i ? QStringLiteral(",?") : QStringLiteral("?");
+    return list;
+}
+
+}
+
+FaviconStore::FaviconStore(QObject *parent)
+    : QObject(parent)
+    , m_db(QStringLiteral("favicons"))
+    , m_byteBudget(DefaultByteBudget)
+    , m_usageTimer(this) // suit le magasin sur le thread de travail
+{
+    m_usageTimer.setSingleShot(true);
+    m_usageTimer.setInterval(UsageFlushDelayMs);
+    connect(&m_usageTimer, &QTimer::timeout, this, &FaviconStore::flushUsage);
+}
+
+FaviconStore::~FaviconStore()
+{
+    if (m_db.isOpen())
+        flushUsage();
+
+    // Le thread de travail termine les écritures en attente avant de s'arrêter
+    if (m_workerThread) {
+        QMetaObject::invokeMethod(m_worker, []() {}, Qt::BlockingQueuedConnection);
+        m_workerThread->quit();
+        m_workerThread->wait();
+    }
+}
+
+bool FaviconStore::open()
+{
+    // Deux connexions (interface + thread de travail) partagent le fichier
+    if (!m_db.open(m_directory + "/favicons.db", "QSQLITE_BUSY_TIMEOUT=5000")) {
+        qWarning() << "Impossible d'ouvrir le cache des favicons :" << m_db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(m_db.database());
+    query.exec("CREATE TABLE IF NOT EXISTS icons ("
+               "hash BLOB PRIMARY KEY, "
+               "data BLOB NOT NULL, "
+               "size INTEGER NOT NULL, "
+               "last_used INTEGER NOT NULL)");
+    query.exec("CREATE INDEX IF NOT EXISTS icons_last_used ON icons (last_used)");
+    query.exec("CREATE TABLE IF NOT EXISTS hosts ("
+               "host TEXT PRIMARY KEY, "
+               "hash BLOB, "
+               "checked_at INTEGER, "
+               "etag BLOB, "
+               "last_modified BLOB, "
+               "from_page INTEGER DEFAULT 0, "
+               "available INTEGER DEFAULT 0)");
+    query.exec("CREATE INDEX IF NOT EXISTS hosts_hash ON hosts (hash)");
+
+    if (query.exec("SELECT COALESCE(SUM(size), 0) FROM icons") && query.next())
+        m_totalBytes = query.value(0).toLongLong();
+    return true;
+}
+
+void FaviconStore::startWorker()
+{
+    if (m_worker || !m_db.isOpen())
+        return;
+
+    m_workerThread = new QThread(this);
+    m_workerThread->setObjectName("FaviconStore");
+
+    m_worker = new FaviconStore;
+    m_worker->m_directory = m_directory;
+    m_worker->m_byteBudget = m_byteBudget;
+    m_worker->moveToThread(m_workerThread);
+    connect(m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(m_worker, &FaviconStore::iconsRemoved, this, &FaviconStore::iconsRemoved);
+    m_workerThread->start();
+
+    // La connexion SQLite doit être ouverte depuis le thread qui l'utilise
+    runOnWorker<bool>([](FaviconStore *worker) {
+        return worker->open();
+    }).then(this, [](bool ok) {
+        if (!ok)
+            qWarning() << "Impossible d'ouvrir le cache des favicons du thread de travail";
+    });
+}
+
+QString FaviconStore::reference(const QByteArray &hash)
+{
+    return ReferencePrefix + QString::fromLatin1(hash.toHex());
+}
+
+QByteArray FaviconStore::hashFromReference(const QString &ref)
+{
+    if (!ref.startsWith(ReferencePrefix))
+        return {};
+    return QByteArray::fromHex(QStringView(ref).mid(ReferencePrefix.size()).toLatin1());
+}
+
+QByteArray FaviconStore::put(const QByteArray &data, bool *inserted)
+{
+    if (inserted)
+        *inserted = false;
+    if (data.isEmpty())
+        return {};
+
+    const QByteArray hash = contentHash(data);
+    QSqlQuery &query = m_db.preparedQuery("INSERT OR IGNORE INTO icons (hash, data, size, last_used) VALUES (?, ?, ?, ?)");
+    query.bindValue(0, hash);
+    query.bindValue(1, data);
+    query.bindValue(2, data.size());
+    query.bindValue(3, QDateTime::currentSecsSinceEpoch());
+    if (!query.exec()) {
+        qWarning() << "Impossible d'enregistrer la favicon :" << query.lastError().text();
+        return {};
+    }
+    const bool added = query.numRowsAffected() > 0;
+    query.finish();
+
+    if (added) {
+        m_totalBytes += data.size();
+        if (m_totalBytes > m_byteBudget)
+            QTimer::singleShot(0, this, &FaviconStore::evict);
+    } else {
+        touch(hash); // déjà là, pour un autre hôte ou une visite précédente
+    }
+    if (inserted)
+        *inserted = added;
+    return hash;
+}
+
+bool FaviconStore::contains(const QByteArray &hash) const
+{
+    if (hash.isEmpty())
+        return false;
+    QSqlQuery &query = m_db.preparedQuery("SELECT 1 FROM icons WHERE hash = ?");
+    query.bindValue(0, hash);
+    const bool found = query.exec() && query.next();
+    query.finish();
+    return found;
+}
+
+QHash<QByteArray, QByteArray> FaviconStore::icons(const QList<QByteArray> &hashes)
+{
+    QHash<QByteArray, QByteArray> result;
+    QList<QByteArray> corrupted;
+    for (qsizetype start = 0; start < hashes.size(); start += MaxBoundHashes) {
+        const QList<QByteArray> batch = hashes.mid(start, MaxBoundHashes);
+        QSqlQuery query(m_db.database());
+        query.setForwardOnly(true);
+        query.prepare("SELECT hash, data FROM icons WHERE hash IN (" + placeholders(batch.size()) + ")");
+        for (qsizetype i = 0; i < batch.size(); ++i)
+            query.bindValue(int(i), batch.at(i));
+        if (!query.exec()) {
+            qWarning() << "Impossible de lire les favicons :" << query.lastError().text();
+            continue;
+        }
+        while (query.next()) {
+            const QByteArray hash = query.value(0).toByteArray();
+            const QByteArray data = query.value(1).toByteArray();
+            if (contentHash(data) != hash) {
+                corrupted.append(hash);
+                continue;
+            }
+            result.insert(hash, data);
+            touch(hash);
+        }
+    }
+
+    if (!corrupted.isEmpty()) {
+        qWarning() << "Favicons corrompues retirées du cache :" << corrupted.size();
+        remove(corrupted);
+    }
+    return result;
+}
+
+FaviconStore::HostEntry FaviconStore::host(const QString &host) const
+{
+    HostEntry entry;
+    QSqlQuery &query = m_db.preparedQuery("SELECT hash, checked_at, etag, last_modified, from_page, available "
+                                     "FROM hosts WHERE host = ?");
+    query.bindValue(0, host);
+    if (query.exec() && query.next()) {
+        entry.hash = query.value(0).toByteArray();
+        if (!query.value(1).isNull())
+            entry.checkedAt = QDateTime::fromSecsSinceEpoch(query.value(1).toLongLong(), QTimeZone::UTC);
+        entry.etag = query.value(2).toByteArray();
+        entry.lastModified = query.value(3).toByteArray();
+        entry.fromPage = query.value(4).toBool();
+        entry.available = query.value(5).toBool() && !entry.hash.isEmpty();
+    }
+    query.finish();
+    return entry;
+}
+
+void FaviconStore::setHost(const QString &host, const HostEntry &entry)
+{
+    QSqlQuery &query = m_db.preparedQuery("INSERT OR REPLACE INTO hosts "
+                                     "(host, hash, checked_at, etag, last_modified, from_page, available) "
+                                     "VALUES (?, ?, ?, ?, ?, ?, ?)");
+    query.bindValue(0, host);
+    query.bindValue(1, entry.hash.isEmpty() ? QVariant(QMetaType(QMetaType::QByteArray)) : QVariant(entry.hash));
+    query.bindValue(2, entry.checkedAt.isValid() ? QVariant(entry.checkedAt.toSecsSinceEpoch())
+                                                 : QVariant(QMetaType(QMetaType::LongLong)));
+    query.bindValue(3, entry.etag);
+    query.bindValue(4, entry.lastModified);
+    query.bindValue(5, entry.fromPage);
+    query.bindValue(6, entry.available);
+    if (!query.exec())
+        qWarning() << "Impossible d'enregistrer la favicon de" << host << query.lastError().text();
+    query.finish();
+}
+
+void FaviconStore::setByteBudget(qint64 bytes)
+{
+    m_byteBudget = qMax<qint64>(bytes, 0);
+    if (m_worker) {
+        QMetaObject::invokeMethod(m_worker, [worker = m_worker, budget = m_byteBudget]() {
+            worker->setByteBudget(budget);
+        }, Qt::QueuedConnection);
+        return;
+    }
+    if (m_totalBytes > m_byteBudget)
+        evict();
+}
+
+QHash<QString, QString> FaviconStore::importLegacyFiles()
+{
+    QHash<QString, QString> references;
+    const QDir dir(m_directory);
+    const QString iniPath = dir.filePath("favicons.ini");
+    const QStringList files = dir.entryList({"*.ico", "*.png"}, QDir::Files);
+    if (files.isEmpty() && !QFile::exists(iniPath))
+        return references;
+
+    QSettings settings(iniPath, QSettings::IniFormat);
+    QSet<QString> imported;
+    QStringList importedFiles;
+    const qint64 totalBytes = m_totalBytes;
+    if (!m_db.transaction()) {
+        qWarning() << "Impossible de reprendre les anciennes favicons :" << m_db.lastError().text();
+        return references;
+    }
+    for (const QString &fileName : files) {
+        const QString path = dir.filePath(fileName);
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+        const QByteArray data = file.readAll();
+        file.close();
+
+        const QByteArray hash = put(data);
+        if (hash.isEmpty())
+            continue;
+        references.insert(path, reference(hash));
+        importedFiles.append(path);
+
+        // Un hôte peut avoir les deux fichiers : favicons.ini dit lequel vaut
+        const QFileInfo info(fileName);
+        const QString host = info.completeBaseName();
+        const bool fromPage = info.suffix() == "png";
+        settings.beginGroup(host);
+        const bool described = settings.contains("fromPage") && settings.value("fromPage").toBool() == fromPage;
+        HostEntry entry;
+        entry.hash = hash;
+        entry.fromPage = fromPage;
+        entry.available = true;
+        if (described) {
+            entry.checkedAt = settings.value("checkedAt").toDateTime();
+            entry.etag = settings.value("etag").toByteArray();
+            entry.lastModified = settings.value("lastModified").toByteArray();
+        }
+        settings.endGroup();
+        if (described || !imported.contains(host)) {
+            setHost(host, entry);
+            imported.insert(host);
+        }
+    }
+    // Les anciens fichiers ne disparaissent qu'une fois la reprise enregistrée
+    if (!m_db.commit()) {
+        qWarning() << "Impossible de reprendre les anciennes favicons :" << m_db.lastError().text();
+        m_db.rollback();
+        m_totalBytes = totalBytes;
+        references.clear();
+        return references;
+    }
+
+    for (const QString &path : std::as_const(importedFiles))
+        QFile::remove(path);
+    QFile::remove(iniPath);
+    return references;
+}
+
+void FaviconStore::touch(const QByteArray &hash)
+{
+    m_used.insert(hash);
+    if (!m_usageTimer.isActive())
+        m_usageTimer.start();
+}
+
+void FaviconStore::flushUsage()
+{
+    m_usageTimer.stop();
+    if (m_used.isEmpty())
+        return;
+
+    // Les lectures de l'interface ne font que noter les dates : le thread de
+    // travail les écrit
+    if (m_worker) {
+        QMetaObject::invokeMethod(m_worker, [worker = m_worker, used = std::exchange(m_used, {})]() {
+            worker->m_used.unite(used);
+            worker->flushUsage();
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    m_db.transaction();
+    QSqlQuery &query = m_db.preparedQuery("UPDATE icons SET last_used = ? WHERE hash = ?");
+    for (const QByteArray &hash : std::as_const(m_used)) {
+        query.bindValue(0, now);
+        query.bindValue(1, hash);
+        query.exec();
+    }
+    query.finish();
+    m_db.commit();
+    m_used.clear();
+}
+
+void FaviconStore::remove(const QList<QByteArray> &hashes)
+{
+    if (hashes.isEmpty())
+        return;
+    if (m_worker) {
+        for (const QByteArray &hash : hashes)
+            m_used.remove(hash);
+        QMetaObject::invokeMethod(m_worker, [worker = m_worker, hashes]() {
+            worker->remove(hashes);
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    m_db.transaction();
+    QSqlQuery &size = m_db.preparedQuery("SELECT size FROM icons WHERE hash = ?");
+    QSqlQuery &removeIcon = m_db.preparedQuery("DELETE FROM icons WHERE hash = ?");
+    // L'hôte sera réinterrogé à la prochaine visite
+    QSqlQuery &forgetHosts = m_db.preparedQuery("DELETE FROM hosts WHERE hash = ?");
+    for (const QByteArray &hash : hashes) {
+        size.bindValue(0, hash);
+        if (size.exec() && size.next())
+            m_totalBytes -= size.value(0).toLongLong();
+        size.finish();
+        removeIcon.bindValue(0, hash);
+        removeIcon.exec();
+        forgetHosts.bindValue(0, hash);
+        forgetHosts.exec();
+        m_used.remove(hash);
+    }
+    removeIcon.finish();
+    forgetHosts.finish();
+    m_db.commit();
+    emit iconsRemoved(hashes);
+}
+
+void FaviconStore::evict()
+{
+    if (m_worker || m_totalBytes <= m_byteBudget)
+        return; // le thread de travail tient seul le total à jour
+
+    // Les dates en attente comptent pour l'ordre LRU
+    flushUsage();
+
+    const qint64 target = m_byteBudget * EvictionTargetPercent / 100;
+    qint64 remaining = m_totalBytes;
+    QList<QByteArray> victims;
+    QSqlQuery &query = m_db.preparedQuery("SELECT hash, size FROM icons ORDER BY last_used ASC");
+    if (query.exec()) {
+        while (remaining > target && query.next()) {
+            victims.append(query.value(0).toByteArray());
+            remaining -= query.value(1).toLongLong();
+        }
+    }
+    query.finish();
+    remove(victims);
+}
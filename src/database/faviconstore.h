@@ -0,0 +1,120 @@
+#ifndef FAVICONSTORE_H
+#define FAVICONSTORE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFuture>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPromise>
+#include <QSet>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QThread>
+#include <QTimer>
+
+#include <memory>
+
+#include "sqliteconnection.h"
+
+// Favicons de tous les sites dans un seul fichier SQLite, à côté du cache.
+// Chaque icône est rangée une fois sous l'empreinte SHA-1 de son contenu :
+// deux hôtes qui servent la même icône partagent le même blob, et les
+// favoris n'en gardent qu'une référence ("favicon:<empreinte>"). Le contenu
+// est revérifié à la lecture. Le total est tenu sous un budget en octets en
+// supprimant les icônes utilisées le moins récemment.
+//
+// Comme pour Database, startWorker() ouvre une seconde connexion sur un
+// thread dédié : les écritures du chargement des pages y passent par
+// runOnWorker, dans l'ordre d'appel, sans bloquer l'interface. Une fois le
+// thread démarré, les dates d'utilisation, les suppressions et l'éviction
+// de cette instance y sont aussi renvoyées ; elle ne sert plus qu'à lire.
+class FaviconStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Ce que l'on sait de l'icône d'un hôte
+    struct HostEntry
+    {
+        QByteArray hash; // vide : aucune icône connue
+        QDateTime checkedAt;
+        QByteArray etag;
+        QByteArray lastModified;
+        bool fromPage = false; // fournie par le moteur plutôt que /favicon.ico
+        bool available = false;
+    };
+
+    explicit FaviconStore(QObject *parent = nullptr);
+    ~FaviconStore();
+    bool open();
+
+    void startWorker();
+    // job(store) exécuté sur le thread de travail, ou tout de suite sur
+    // celui-ci s'il n'a pas été démarré
+    template <typename T, typename Job>
+    QFuture<T> runOnWorker(Job job);
+
+    static QString reference(const QByteArray &hash);
+    // Empreinte désignée par une référence, vide s'il s'agit d'un chemin de fichier
+    static QByteArray hashFromReference(const QString &ref);
+
+    // Range data et renvoie son empreinte ; inserted indique si le blob
+    // n'était pas déjà présent
+    QByteArray put(const QByteArray &data, bool *inserted = nullptr);
+    bool contains(const QByteArray &hash) const;
+    // Contenus de plusieurs icônes en une requête ; les absentes et celles
+    // dont le contenu ne correspond plus à l'empreinte sont omises
+    QHash<QByteArray, QByteArray> icons(const QList<QByteArray> &hashes);
+
+    HostEntry host(const QString &host) const;
+    void setHost(const QString &host, const HostEntry &entry);
+
+    qint64 byteBudget() const { return m_byteBudget; }
+    void setByteBudget(qint64 bytes);
+    // Une fois le thread de travail démarré, c'est lui qui tient le total
+    qint64 totalBytes() const { return m_totalBytes; }
+
+    // Reprise des anciens fichiers <hôte>.ico / <hôte>.png et de favicons.ini
+    // du répertoire de cache ; renvoie ancien chemin -> référence. En cas
+    // d'échec, rien n'est renvoyé et les fichiers restent pour la prochaine fois
+    QHash<QString, QString> importLegacyFiles();
+
+signals:
+    // Icônes supprimées du store (éviction, contenu corrompu)
+    void iconsRemoved(const QList<QByteArray> &hashes);
+
+private:
+    void touch(const QByteArray &hash);
+    void flushUsage();
+    void remove(const QList<QByteArray> &hashes);
+    void evict();
+
+    SqliteConnection m_db;
+    qint64 m_byteBudget;
+    qint64 m_totalBytes = 0;
+    QSet<QByteArray> m_used; // dates d'utilisation pas encore écrites
+    QTimer m_usageTimer;
+    QThread *m_workerThread = nullptr;
+    FaviconStore *m_worker = nullptr;
+    QString m_directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+};
+
+template <typename T, typename Job>
+QFuture<T> FaviconStore::runOnWorker(Job job)
+{
+    if (!m_worker)
+        return QtFuture::makeReadyValueFuture(job(this));
+
+    auto promise = std::make_shared<QPromise<T>>();
+    QFuture<T> future = promise->future();
+    promise->start();
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, promise, job]() {
+        promise->addResult(job(worker));
+        promise->finish();
+    }, Qt::QueuedConnection);
+    return future;
+}
+
+#endif // FAVICONSTORE_H
@@ -0,0 +1,90 @@
+#include "favoriteposition.h"
+
+namespace {
+
+constexpr int Base = 36;
+constexpr char Digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+int digitAt(const QString &key, qsizetype index)
+{
+    if (index >= key.size())
+        return 0;
+    const char16_t c = key.at(index).unicode();
+    if (c >= u'0' && c <= u'9')
+        return c - u'0';
+    if (c >= u'a' && c <= u'z')
+        return c - u'a' + 10;
+    return 0;
+}
+
+} // namespace
+
+namespace FavoritePosition {
+
+QString between(const QString &before, const QString &after)
+{
+    // Préfixe commun : la clé le reprend et se décide sur la suite
+    if (!after.isEmpty()) {
+        qsizetype n = 0;
+        while (n < after.size() && digitAt(before, n) == digitAt(after, n))
+            ++n;
+        if (n > 0)
+            return after.left(n) + between(before.mid(n), after.mid(n));
+    }
+
+    const int low = before.isEmpty() ? 0 : digitAt(before, 0);
+    const int high = after.isEmpty() ? Base : digitAt(after, 0);
+    if (high - low > 1)
+        return QString(QLatin1Char(Digits[(low + high) / 2]));
+
+    // Chiffres consécutifs : le premier chiffre de after suffit s'il est
+    // suivi d'autre chose, sinon on descend d'un rang après before
+    if (after.size() > 1)
+        return after.left(1);
+    return QLatin1Char(Digits[low]) + between(before.mid(1), QString());
+}
+
+QString after(const QString &key)
+{
+    if (key.isEmpty())
+        return between(QString(), QString());
+    for (qsizetype i = 0; i < key.size(); ++i) {
+        const int digit = digitAt(key, i);
+        if (digit < Base - 1)
+            return key.left(i) + QLatin1Char(Digits[digit + 1]);
+    }
+    return key + QLatin1Char('1');
+}
+
+QStringList sequence(const QString &key, qsizetype count)
+{
+    QStringList keys;
+    if (count <= 0)
+        return keys;
+    keys.reserve(count);
+
+    // Largeur fixe juste suffisante pour count valeurs distinctes
+    const QString prefix = key.isEmpty() ? QString() : after(key);
+    int width = 1;
+    qint64 capacity = Base;
+    while (capacity <= count) {
+        capacity *= Base;
+        ++width;
+    }
+    const qint64 step = capacity / (count + 1);
+
+    for (qsizetype i = 1; i <= count; ++i) {
+        qint64 value = i * step;
+        QString digits(width, QLatin1Char('0'));
+        for (int d = width - 1; d >= 0; --d) {
+            digits[d] = QLatin1Char(Digits[value % Base]);
+            value /= Base;
+        }
+        while (digits.endsWith(QLatin1Char('0')))
+            digits.chop(1);
+        keys.append(prefix + digits);
+    }
+    return keys;
+}
+
+} // namespace FavoritePosition
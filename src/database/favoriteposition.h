@@ -0,0 +1,28 @@
+#ifndef FAVORITEPOSITION_H
+#define FAVORITEPOSITION_H
+
+#include <QString>
+#include <QStringList>
+
+// Clés d'ordre fractionnaires pour la colonne favorites.position.
+// Une clé est une suite de chiffres en base 36 (0-9a-z) lue comme la partie
+// décimale d'un nombre entre 0 et 1 : l'ordre lexicographique des chaînes est
+// donc l'ordre des favoris. Une clé ne se termine jamais par '0', ce qui
+// garantit qu'il existe toujours une clé entre deux autres : déplacer un
+// favori ne réécrit que sa propre ligne.
+namespace FavoritePosition {
+
+// Clé strictement entre before et after ; une chaîne vide signifie
+// « aucune borne » de ce côté. before doit être inférieure à after.
+QString between(const QString &before, const QString &after);
+
+// Clé strictement supérieure à key, la plus courte possible
+QString after(const QString &key);
+
+// count clés croissantes, régulièrement espacées, toutes supérieures à
+// key : pour les insertions en masse et la migration
+QStringList sequence(const QString &key, qsizetype count);
+
+} // namespace FavoritePosition
+
+#endif // FAVORITEPOSITION_H
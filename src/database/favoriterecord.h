@@ -0,0 +1,21 @@
+#ifndef FAVORITERECORD_H
+#define FAVORITERECORD_H
+
+#include <QString>
+
+// Ligne de la table favorites, décodée sans passer par QMap/QVariant
+struct FavoriteRecord {
+    int id = -1;
+    // Chaînes vides mais non nulles : title et url sont NOT NULL en base,
+    // et Qt lie une QString nulle comme NULL
+    QString title = QLatin1String("");
+    QString url = QLatin1String("");
+    QString iconPath;
+    int parentId = 0;
+    QString position; // clé d'ordre parmi les frères, voir FavoritePosition
+
+    bool isValid() const { return id != -1; }
+    bool isFolder() const { return url.isEmpty(); }
+};
+
+#endif // FAVORITERECORD_H
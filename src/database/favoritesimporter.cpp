@@ -0,0 +1,403 @@
+#include "favoritesimporter.h"
+
+#include <QSet>
+#include <QStack>
+
+namespace {
+
+constexpr qint64 ChunkSize = 64 * 1024;
+
+void appendUtf8(QByteArray &out, char32_t codePoint)
+{
+    if (codePoint < 0x80) {
+        out.append(char(codePoint));
+    } else if (codePoint < 0x800) {
+        out.append(char(0xC0 | (codePoint >> 6)));
+        out.append(char(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        out.append(char(0xE0 | (codePoint >> 12)));
+        out.append(char(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.append(char(0x80 | (codePoint & 0x3F)));
+    } else {
+        out.append(char(0xF0 | (codePoint >> 18)));
+        out.append(char(0x80 | ((codePoint >> 12) & 0x3F)));
+        out.append(char(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.append(char(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+// Contexte de lecture : un tableau de favoris ou un favori en cours
+struct Frame {
+    bool isArray;
+    bool first = true;
+    int parentId = 0;
+    FavoriteRecord record;
+    // Format à plat : identifiants du fichier, rapprochés à la fin de la lecture
+    QString fileId;
+    QString fileParentId;
+    bool folder = false;
+};
+
+} // namespace
+
+FavoritesImporter::FavoritesImporter(int firstId)
+    : m_nextId(firstId)
+{
+}
+
+bool FavoritesImporter::fill()
+{
+    if (m_atEnd)
+        return false;
+    m_buffer = m_device->read(ChunkSize);
+    m_pos = 0;
+    if (m_buffer.isEmpty()) {
+        m_atEnd = true;
+        return false;
+    }
+    return true;
+}
+
+char FavoritesImporter::peek()
+{
+    if (m_pos >= m_buffer.size() && !fill())
+        return '\0';
+    return m_buffer.at(m_pos);
+}
+
+char FavoritesImporter::get()
+{
+    const char c = peek();
+    if (c != '\0')
+        ++m_pos;
+    return c;
+}
+
+void FavoritesImporter::skipWhitespace()
+{
+    for (;;) {
+        const char c = peek();
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+            return;
+        ++m_pos;
+    }
+}
+
+bool FavoritesImporter::expect(char c)
+{
+    skipWhitespace();
+    if (get() != c)
+        return fail(QStringLiteral("'%1' attendu").arg(QLatin1Char(c)));
+    return true;
+}
+
+bool FavoritesImporter::fail(const QString &message)
+{
+    if (m_error.isEmpty())
+        m_error = message;
+    return false;
+}
+
+bool FavoritesImporter::readString(QString &out)
+{
+    // Le guillemet ouvrant a déjà été consommé
+    QByteArray bytes;
+    for (;;) {
+        if (m_pos >= m_buffer.size() && !fill())
+            return fail(QStringLiteral("Chaîne non terminée"));
+
+        // Copier d'un bloc tout ce qui précède le prochain guillemet ou échappement
+        const char *data = m_buffer.constData();
+        qsizetype end = m_pos;
+        while (end < m_buffer.size() && data[end] != '"' && data[end] != '\\')
+            ++end;
+        bytes.append(data + m_pos, end - m_pos);
+        m_pos = end;
+        if (m_pos >= m_buffer.size())
+            continue;
+
+        if (get() == '"')
+            break;
+
+        const char escaped = get();
+        switch (escaped) {
+        case '"': bytes.append('"'); break;
+        case '\\': bytes.append('\\'); break;
+        case '/': bytes.append('/'); break;
+        case 'b': bytes.append('\b'); break;
+        case 'f': bytes.append('\f'); break;
+        case 'n': bytes.append('\n'); break;
+        case 'r': bytes.append('\r'); break;
+        case 't': bytes.append('\t'); break;
+        case 'u': {
+            char32_t codePoint = 0;
+            for (int i = 0; i < 4; ++i) {
+                const int digit = hexValue(get());
+                if (digit < 0)
+                    return fail(QStringLiteral("Séquence \\u invalide"));
+                codePoint = (codePoint << 4) | char32_t(digit);
+            }
+            // Paire de substitution UTF-16
+            if (codePoint >= 0xD800 && codePoint < 0xDC00 && peek() == '\\') {
+                get();
+                if (get() != 'u')
+                    return fail(QStringLiteral("Paire de substitution invalide"));
+                char32_t low = 0;
+                for (int i = 0; i < 4; ++i) {
+                    const int digit = hexValue(get());
+                    if (digit < 0)
+                        return fail(QStringLiteral("Séquence \\u invalide"));
+                    low = (low << 4) | char32_t(digit);
+                }
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+            }
+            appendUtf8(bytes, codePoint);
+            break;
+        }
+        default:
+            return fail(QStringLiteral("Échappement invalide"));
+        }
+    }
+    // "" reste une chaîne vide non nulle, comme attendu par les colonnes NOT NULL
+    out = bytes.isEmpty() ? QString(QLatin1String("")) : QString::fromUtf8(bytes);
+    return true;
+}
+
+bool FavoritesImporter::skipString()
+{
+    for (;;) {
+        const char c = get();
+        if (c == '\0')
+            return fail(QStringLiteral("Chaîne non terminée"));
+        if (c == '"')
+            return true;
+        if (c == '\\')
+            get();
+    }
+}
+
+bool FavoritesImporter::readScalar(QString &out)
+{
+    skipWhitespace();
+    const char c = peek();
+    if (c == '"') {
+        get();
+        return readString(out);
+    }
+    if (c == '{' || c == '[') {
+        out.clear();
+        return skipValue();
+    }
+
+    // Nombre ou littéral (true, false, null)
+    QByteArray token;
+    for (;;) {
+        const char t = peek();
+        if (t == '\0' || t == ',' || t == '}' || t == ']'
+            || t == ' ' || t == '\n' || t == '\r' || t == '\t')
+            break;
+        token.append(get());
+    }
+    if (token.isEmpty())
+        return fail(QStringLiteral("Valeur attendue"));
+    out = token == "null" ? QString() : QString::fromLatin1(token);
+    return true;
+}
+
+bool FavoritesImporter::skipValue()
+{
+    skipWhitespace();
+    int depth = 0;
+    do {
+        const char c = get();
+        switch (c) {
+        case '\0':
+            return fail(QStringLiteral("Fin de fichier inattendue"));
+        case '"':
+            if (!skipString())
+                return false;
+            break;
+        case '{':
+        case '[':
+            ++depth;
+            break;
+        case '}':
+        case ']':
+            --depth;
+            break;
+        default:
+            if (depth == 0) {
+                // Littéral : consommer jusqu'au prochain séparateur
+                for (;;) {
+                    const char t = peek();
+                    if (t == '\0' || t == ',' || t == '}' || t == ']'
+                        || t == ' ' || t == '\n' || t == '\r' || t == '\t')
+                        break;
+                    get();
+                }
+            }
+            break;
+        }
+    } while (depth > 0);
+    return true;
+}
+
+bool FavoritesImporter::read(QIODevice *device)
+{
+    m_device = device;
+    m_buffer.clear();
+    m_pos = 0;
+    m_atEnd = false;
+    m_records.clear();
+    m_error.clear();
+
+    if (!expect('['))
+        return false;
+
+    QHash<QString, int> idsByFileId;
+    QStringList parentRefs; // parent_id de chaque enregistrement, dans l'ordre
+
+    // Pile explicite : la profondeur d'imbrication des dossiers n'est pas bornée
+    QStack<Frame> stack;
+    stack.push(Frame{true, true, 0, {}});
+
+    while (!stack.isEmpty()) {
+        Frame &frame = stack.top();
+        skipWhitespace();
+
+        if (frame.isArray) {
+            if (peek() == ']') {
+                get();
+                stack.pop();
+                continue;
+            }
+            if (!frame.first && !expect(','))
+                return false;
+            frame.first = false;
+
+            skipWhitespace();
+            if (peek() != '{') {
+                // Entrée qui n'est pas un objet : ignorée
+                if (!skipValue())
+                    return false;
+                continue;
+            }
+            get();
+            Frame item{false, true, frame.parentId, {}};
+            item.record.id = m_nextId++;
+            item.record.parentId = frame.parentId;
+            stack.push(item);
+            continue;
+        }
+
+        if (peek() == '}') {
+            get();
+            // "url": null, ou un dossier sans titre
+            if (frame.folder || frame.record.url.isNull())
+                frame.record.url = QLatin1String("");
+            if (frame.record.title.isNull())
+                frame.record.title = QLatin1String("");
+            if (!frame.fileId.isEmpty())
+                idsByFileId.insert(frame.fileId, frame.record.id);
+            parentRefs.append(frame.fileParentId);
+            m_records.append(frame.record);
+            stack.pop();
+            continue;
+        }
+        if (!frame.first && !expect(','))
+            return false;
+        frame.first = false;
+
+        QString key;
+        if (!expect('"') || !readString(key) || !expect(':'))
+            return false;
+
+        skipWhitespace();
+        if (key == QLatin1String("children") && peek() == '[') {
+            get();
+            // frame est invalidée par le push : copier l'id avant
+            const int folderId = frame.record.id;
+            stack.push(Frame{true, true, folderId, {}});
+            continue;
+        }
+
+        QString value;
+        if (key == QLatin1String("title") || key == QLatin1String("name")) {
+            if (!readScalar(value))
+                return false;
+            if (frame.record.title.isEmpty())
+                frame.record.title = value;
+        } else if (key == QLatin1String("url")) {
+            if (!readScalar(frame.record.url))
+                return false;
+        } else if (key == QLatin1String("favicon") || key == QLatin1String("icon_path")) {
+            if (!readScalar(frame.record.iconPath))
+                return false;
+        } else if (key == QLatin1String("id")) {
+            if (!readScalar(frame.fileId))
+                return false;
+        } else if (key == QLatin1String("parent_id")) {
+            if (!readScalar(frame.fileParentId))
+                return false;
+        } else if (key == QLatin1String("folder")) {
+            if (!readScalar(value))
+                return false;
+            frame.folder = value == QLatin1String("true");
+        } else if (!skipValue()) {
+            return false;
+        }
+    }
+
+    resolveParents(idsByFileId, parentRefs);
+    return true;
+}
+
+void FavoritesImporter::resolveParents(const QHash<QString, int> &idsByFileId, const QStringList &parentRefs)
+{
+    if (idsByFileId.isEmpty())
+        return;
+
+    QHash<int, qsizetype> indexById;
+    indexById.reserve(m_records.size());
+    for (qsizetype i = 0; i < m_records.size(); ++i)
+        indexById.insert(m_records.at(i).id, i);
+
+    // L'imbrication prime : parent_id ne place que les entrées de premier
+    // niveau, et seulement sous un dossier connu du fichier ; 0 est la racine
+    for (qsizetype i = 0; i < m_records.size(); ++i) {
+        FavoriteRecord &record = m_records[i];
+        const QString &ref = parentRefs.at(i);
+        if (record.parentId != 0 || ref.isEmpty() || ref == QLatin1String("0"))
+            continue;
+        const int parentId = idsByFileId.value(ref, 0);
+        if (parentId == 0 || parentId == record.id)
+            continue;
+        if (m_records.at(indexById.value(parentId)).isFolder())
+            record.parentId = parentId;
+    }
+
+    // Des parent_id en boucle rendraient le groupe inaccessible depuis la
+    // racine : l'entrée où la boucle est détectée y est rattachée
+    for (qsizetype i = 0; i < m_records.size(); ++i) {
+        QSet<int> seen{m_records.at(i).id};
+        for (int parentId = m_records.at(i).parentId; parentId != 0;
+             parentId = m_records.at(indexById.value(parentId)).parentId) {
+            if (seen.contains(parentId)) {
+                m_records[i].parentId = 0;
+                break;
+            }
+            seen.insert(parentId);
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef FAVORITESIMPORTER_H
+#define FAVORITESIMPORTER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QIODevice>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "favoriterecord.h"
+
+// Lecture en flux d'un favorites.json : le fichier est parcouru par blocs,
+// sans construire de QJsonDocument, et les dossiers peuvent être imbriqués
+// à n'importe quelle profondeur. Les identifiants sont attribués à partir de
+// firstId pour que les enfants connaissent leur parent avant son insertion.
+//
+// L'ancien format à plat est aussi lu : chaque entrée de premier niveau peut
+// porter un "id" et un "parent_id" qui désigne l'"id" d'un autre dossier du
+// fichier ; "folder": true en fait un dossier.
+class FavoritesImporter
+{
+public:
+    explicit FavoritesImporter(int firstId);
+
+    bool read(QIODevice *device);
+
+    const QVector<FavoriteRecord> &records() const { return m_records; }
+    QString errorString() const { return m_error; }
+
+private:
+    char peek();
+    char get();
+    void skipWhitespace();
+    bool expect(char c);
+    bool fill();
+
+    bool readString(QString &out);
+    bool readScalar(QString &out);
+    bool skipString();
+    bool skipValue();
+
+    bool fail(const QString &message);
+    void resolveParents(const QHash<QString, int> &idsByFileId, const QStringList &parentRefs);
+
+    QIODevice *m_device = nullptr;
+    QByteArray m_buffer;
+    qsizetype m_pos = 0;
+    bool m_atEnd = false;
+
+    int m_nextId;
+    QVector<FavoriteRecord> m_records;
+    QString m_error;
+};
+
+#endif // FAVORITESIMPORTER_H
@@ -0,0 +1,21 @@
+#ifndef FAVORITEWRITE_H
+#define FAVORITEWRITE_H
+
+#include <QString>
+
+// Écriture différée sur la table favorites : FavoritesModel les accumule et
+// Database::applyWrites les exécute dans l'ordre, en une seule transaction
+struct FavoriteWrite {
+    enum Kind { Move, Icon };
+
+    Kind kind = Move;
+    int id = -1;
+    // Move : même sens que Database::moveFavorite
+    int parentId = 0;
+    int prevId = -1;
+    int nextId = -1;
+    // Icon
+    QString iconPath;
+};
+
+#endif // FAVORITEWRITE_H
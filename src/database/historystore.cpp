@@ -0,0 +1,43 @@
+#include "historystore.h"
+
+#include <QDebug>
+#include <QSqlError>
+
+HistoryStore::HistoryStore()
+    : m_db(QStringLiteral("history"))
+{
+}
+
+bool HistoryStore::open()
+{
+    if (!m_db.open(m_dbPath)) {
+        qWarning() << "Impossible d'ouvrir l'historique :" << m_db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(m_db.database());
+    query.exec("CREATE TABLE IF NOT EXISTS history ("
+               "url_key TEXT PRIMARY KEY, "
+               "url TEXT NOT NULL, "
+               "title TEXT, "
+               "visit_count INTEGER NOT NULL DEFAULT 0, "
+               "last_visit INTEGER NOT NULL DEFAULT 0)");
+    return true;
+}
+
+void HistoryStore::recordVisit(const Row &row)
+{
+    QSqlQuery &query = m_db.preparedQuery("INSERT INTO history (url_key, url, title, visit_count, last_visit) "
+                                     "VALUES (?, ?, ?, ?, ?) "
+                                     "ON CONFLICT(url_key) DO UPDATE SET url = excluded.url, "
+                                     "title = excluded.title, visit_count = excluded.visit_count, "
+                                     "last_visit = excluded.last_visit");
+    query.bindValue(0, row.key);
+    query.bindValue(1, row.url);
+    query.bindValue(2, row.title);
+    query.bindValue(3, row.visitCount);
+    query.bindValue(4, row.lastVisit);
+    if (!query.exec())
+        qWarning() << "Impossible d'enregistrer la visite de" << row.url << query.lastError().text();
+    query.finish();
+}
@@ -0,0 +1,57 @@
+#ifndef HISTORYSTORE_H
+#define HISTORYSTORE_H
+
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QString>
+
+#include "sqliteconnection.h"
+
+// Historique de navigation réduit à ce qu'il faut pour les suggestions de la
+// barre d'adresse : une ligne par adresse (titre, nombre de visites, date de
+// la dernière). La connexion appartient au thread qui appelle open().
+class HistoryStore
+{
+public:
+    struct Row
+    {
+        QString key; // adresse normalisée, voir OmniboxIndex::urlKey
+        QString url;
+        QString title;
+        int visitCount = 0;
+        qint64 lastVisit = 0; // secondes depuis l'epoch
+    };
+
+    HistoryStore();
+    bool open();
+
+    // Toutes les lignes, sans les garder en mémoire ici
+    template <typename Fn>
+    void forEach(Fn fn) const;
+
+    void recordVisit(const Row &row);
+
+private:
+    SqliteConnection m_db;
+    QString m_dbPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/history.db";
+};
+
+template <typename Fn>
+void HistoryStore::forEach(Fn fn) const
+{
+    QSqlQuery query(m_db.database());
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT url_key, url, title, visit_count, last_visit FROM history"))
+        return;
+    while (query.next()) {
+        Row row;
+        row.key = query.value(0).toString();
+        row.url = query.value(1).toString();
+        row.title = query.value(2).toString();
+        row.visitCount = query.value(3).toInt();
+        row.lastVisit = query.value(4).toLongLong();
+        fn(row);
+    }
+}
+
+#endif // HISTORYSTORE_H
@@ -0,0 +1,199 @@
+#include "sessionstore.h"
+
+#include <QDebug>
+#include <QHash>
+#include <QSqlError>
+#include <QSqlRecord>
+
+namespace {
+
+// Au pire, une seconde de navigation est perdue en cas d'arrêt brutal
+constexpr int CommitDelayMs = 1000;
+
+}
+
+SessionStore::SessionStore(QObject *parent)
+    : QObject(parent)
+    , m_db(QStringLiteral("session"))
+{
+    m_commitTimer.setSingleShot(true);
+    m_commitTimer.setInterval(CommitDelayMs);
+    connect(&m_commitTimer, &QTimer::timeout, this, &SessionStore::commit);
+}
+
+SessionStore::~SessionStore()
+{
+    commit();
+}
+
+bool SessionStore::open()
+{
+    if (!m_db.open(m_dbPath)) {
+        qWarning() << "Impossible d'ouvrir la session :" << m_db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(m_db.database());
+    query.exec("CREATE TABLE IF NOT EXISTS windows ("
+               "id INTEGER PRIMARY KEY, "
+               "current_tab INTEGER NOT NULL DEFAULT -1)");
+    query.exec("CREATE TABLE IF NOT EXISTS tabs ("
+               "id INTEGER PRIMARY KEY, "
+               "window_id INTEGER NOT NULL, "
+               "position TEXT NOT NULL, "
+               "url TEXT, "
+               "title TEXT, "
+               "history BLOB, "
+               "icon BLOB)");
+    // Sessions enregistrées avant l'ajout des icônes
+    if (!m_db.database().record("tabs").contains("icon"))
+        query.exec("ALTER TABLE tabs ADD COLUMN icon BLOB");
+    query.exec("CREATE INDEX IF NOT EXISTS tabs_window ON tabs(window_id, position)");
+    return true;
+}
+
+QList<SessionStore::Window> SessionStore::load()
+{
+    if (!m_db.isOpen())
+        return {};
+    commit();
+
+    QList<Window> windows;
+    QHash<int, qsizetype> indexById;
+    QSqlQuery query(m_db.database());
+    query.setForwardOnly(true);
+    query.exec("SELECT id, current_tab FROM windows ORDER BY id");
+    while (query.next()) {
+        Window window;
+        window.id = query.value(0).toInt();
+        window.currentTab = query.value(1).toInt();
+        indexById.insert(window.id, windows.size());
+        windows.append(window);
+    }
+
+    query.exec("SELECT id, window_id, position, url, title, history, icon FROM tabs ORDER BY window_id, position");
+    while (query.next()) {
+        const qsizetype index = indexById.value(query.value(1).toInt(), -1);
+        if (index == -1)
+            continue;
+        Tab tab;
+        tab.id = query.value(0).toInt();
+        tab.position = query.value(2).toString();
+        tab.url = QUrl(query.value(3).toString());
+        tab.title = query.value(4).toString();
+        tab.history = query.value(5).toByteArray();
+        tab.icon = query.value(6).toByteArray();
+        windows[index].tabs.append(tab);
+    }
+    query.finish();
+
+    // Restes d'une fenêtre fermée pendant un arrêt brutal
+    for (qsizetype i = windows.size() - 1; i >= 0; --i) {
+        if (windows.at(i).tabs.isEmpty()) {
+            removeWindow(windows.at(i).id);
+            windows.removeAt(i);
+        }
+    }
+    return windows;
+}
+
+int SessionStore::addWindow()
+{
+    QSqlQuery &query = m_db.preparedQuery("INSERT INTO windows (current_tab) VALUES (-1)");
+    QVariant id;
+    return exec(query, &id) ? id.toInt() : -1;
+}
+
+void SessionStore::removeWindow(int id)
+{
+    QSqlQuery &tabs = m_db.preparedQuery("DELETE FROM tabs WHERE window_id = ?");
+    tabs.bindValue(0, id);
+    exec(tabs);
+    QSqlQuery &window = m_db.preparedQuery("DELETE FROM windows WHERE id = ?");
+    window.bindValue(0, id);
+    exec(window);
+}
+
+void SessionStore::adoptWindow(int from, int to)
+{
+    QSqlQuery &tabs = m_db.preparedQuery("UPDATE tabs SET window_id = ? WHERE window_id = ?");
+    tabs.bindValue(0, to);
+    tabs.bindValue(1, from);
+    exec(tabs);
+    QSqlQuery &window = m_db.preparedQuery("DELETE FROM windows WHERE id = ?");
+    window.bindValue(0, from);
+    exec(window);
+}
+
+void SessionStore::setCurrentTab(int windowId, int tabId)
+{
+    QSqlQuery &query = m_db.preparedQuery("UPDATE windows SET current_tab = ? WHERE id = ?");
+    query.bindValue(0, tabId);
+    query.bindValue(1, windowId);
+    exec(query);
+}
+
+int SessionStore::addTab(int windowId, const QString &position)
+{
+    QSqlQuery &query = m_db.preparedQuery("INSERT INTO tabs (window_id, position) VALUES (?, ?)");
+    query.bindValue(0, windowId);
+    query.bindValue(1, position);
+    QVariant id;
+    return exec(query, &id) ? id.toInt() : -1;
+}
+
+void SessionStore::removeTab(int id)
+{
+    QSqlQuery &query = m_db.preparedQuery("DELETE FROM tabs WHERE id = ?");
+    query.bindValue(0, id);
+    exec(query);
+}
+
+void SessionStore::moveTab(int id, const QString &position)
+{
+    QSqlQuery &query = m_db.preparedQuery("UPDATE tabs SET position = ? WHERE id = ?");
+    query.bindValue(0, position);
+    query.bindValue(1, id);
+    exec(query);
+}
+
+void SessionStore::updateTab(int id, const QUrl &url, const QString &title, const QByteArray &history,
+                             const QByteArray &icon)
+{
+    QSqlQuery &query = m_db.preparedQuery("UPDATE tabs SET url = ?, title = ?, history = ?, icon = ? WHERE id = ?");
+    query.bindValue(0, url.toString());
+    query.bindValue(1, title);
+    query.bindValue(2, history);
+    query.bindValue(3, icon);
+    query.bindValue(4, id);
+    exec(query);
+}
+
+void SessionStore::commit()
+{
+    m_commitTimer.stop();
+    if (!m_inTransaction)
+        return;
+    m_inTransaction = false;
+    if (!m_db.commit())
+        qWarning() << "Impossible d'enregistrer la session :" << m_db.lastError().text();
+}
+
+bool SessionStore::exec(QSqlQuery &query, QVariant *insertId)
+{
+    if (!m_db.isOpen())
+        return false;
+    // La transaction s'ouvre à la première écriture et se referme une
+    // seconde plus tard : une rafale d'événements ne coûte qu'un commit
+    if (!m_inTransaction) {
+        m_inTransaction = m_db.transaction();
+        m_commitTimer.start();
+    }
+    const bool ok = query.exec();
+    if (!ok)
+        qWarning() << "Écriture de la session impossible :" << query.lastError().text();
+    else if (insertId)
+        *insertId = query.lastInsertId(); // seulement tant que la requête est active
+    query.finish();
+    return ok;
+}
@@ -0,0 +1,74 @@
+#ifndef SESSIONSTORE_H
+#define SESSIONSTORE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QString>
+#include <QTimer>
+#include <QUrl>
+#include <QVariant>
+
+#include "sqliteconnection.h"
+
+// Fenêtres et onglets ouverts, pour les retrouver au démarrage suivant.
+// Chaque événement (ouverture, fermeture, navigation, déplacement d'un
+// onglet) n'écrit que sa propre ligne ; les écritures d'une seconde sont
+// regroupées dans une transaction. L'ordre des onglets utilise les mêmes
+// clés fractionnaires que les favoris : un déplacement ne réécrit qu'une ligne.
+class SessionStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Tab
+    {
+        int id = -1;
+        QString position;
+        QUrl url;
+        QString title;
+        QByteArray history; // QWebEngineHistory sérialisé
+        QByteArray icon; // PNG de l'icône de la page, vide si elle n'en a pas
+    };
+
+    struct Window
+    {
+        int id = -1;
+        int currentTab = -1;
+        QList<Tab> tabs; // dans l'ordre de la barre d'onglets
+    };
+
+    explicit SessionStore(QObject *parent = nullptr);
+    ~SessionStore();
+    bool open();
+    bool isOpen() const { return m_db.isOpen(); }
+
+    // Fenêtres non vides de la session précédente
+    QList<Window> load();
+
+    int addWindow();
+    void removeWindow(int id);
+    // Les onglets de from passent dans to, from disparaît
+    void adoptWindow(int from, int to);
+    void setCurrentTab(int windowId, int tabId);
+
+    int addTab(int windowId, const QString &position);
+    void removeTab(int id);
+    void moveTab(int id, const QString &position);
+    void updateTab(int id, const QUrl &url, const QString &title, const QByteArray &history,
+                   const QByteArray &icon);
+
+    void commit();
+
+private:
+    bool exec(QSqlQuery &query, QVariant *insertId = nullptr);
+
+    SqliteConnection m_db;
+    bool m_inTransaction = false;
+    QTimer m_commitTimer;
+    QString m_dbPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/session.db";
+};
+
+#endif // SESSIONSTORE_H
@@ -0,0 +1,56 @@
+#include "sqliteconnection.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+
+SqliteConnection::SqliteConnection(const QString &prefix)
+    : m_name(QStringLiteral("%1-%2").arg(prefix).arg(quintptr(this), 0, 16))
+{
+}
+
+SqliteConnection::~SqliteConnection()
+{
+    close();
+}
+
+bool SqliteConnection::open(const QString &path, const QString &options)
+{
+    close();
+    QDir().mkpath(QFileInfo(path).path());
+    m_db = QSqlDatabase::addDatabase("QSQLITE", m_name);
+    m_db.setDatabaseName(path);
+    if (!options.isEmpty())
+        m_db.setConnectOptions(options);
+    if (!m_db.open())
+        return false;
+
+    QSqlQuery query(m_db);
+    query.exec("PRAGMA journal_mode=WAL");
+    query.exec("PRAGMA synchronous=NORMAL");
+    return true;
+}
+
+void SqliteConnection::close()
+{
+    // Les requêtes préparées doivent disparaître avant la connexion
+    m_statements.clear();
+    if (m_db.isValid()) {
+        m_db.close();
+        m_db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(m_name);
+    }
+}
+
+QSqlQuery &SqliteConnection::preparedQuery(const QString &sql) const
+{
+    auto it = m_statements.find(sql);
+    if (it == m_statements.end()) {
+        QSqlQuery query(m_db);
+        query.setForwardOnly(true);
+        if (!query.prepare(sql))
+            qWarning() << "Impossible de préparer la requête :" << sql << query.lastError().text();
+        it = m_statements.insert(sql, query);
+    }
+    return it.value();
+}
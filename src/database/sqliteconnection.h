@@ -0,0 +1,43 @@
+#ifndef SQLITECONNECTION_H
+#define SQLITECONNECTION_H
+
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QString>
+
+// Connexion SQLite nommée, propre à un objet et au thread qui l'ouvre, avec
+// son cache de requêtes préparées. Partagée par toutes les bases du
+// navigateur : WAL et synchronous=NORMAL, pour que les lectures ne bloquent
+// pas pendant une écriture et que fsync n'ait lieu qu'aux checkpoints.
+class SqliteConnection
+{
+public:
+    // Le nom de la connexion est prefix suivi de l'adresse de l'objet
+    explicit SqliteConnection(const QString &prefix);
+    ~SqliteConnection();
+    Q_DISABLE_COPY(SqliteConnection)
+
+    // Crée le dossier du fichier si besoin ; options : voir
+    // QSqlDatabase::setConnectOptions
+    bool open(const QString &path, const QString &options = QString());
+    void close();
+
+    QSqlDatabase database() const { return m_db; }
+    bool isOpen() const { return m_db.isOpen(); }
+    QSqlError lastError() const { return m_db.lastError(); }
+    bool transaction() { return m_db.transaction(); }
+    bool commit() { return m_db.commit(); }
+    bool rollback() { return m_db.rollback(); }
+
+    // Requêtes préparées une seule fois et réutilisées tant que la connexion est ouverte
+    QSqlQuery &preparedQuery(const QString &sql) const;
+
+private:
+    QSqlDatabase m_db;
+    QString m_name;
+    mutable QHash<QString, QSqlQuery> m_statements;
+};
+
+#endif // SQLITECONNECTION_H
@@ -0,0 +1,199 @@
+#include "faviconcache.h"
+#include "faviconstore.h"
+#include "favoritesmodel.h"
+#include "iconcache.h"
+
+#include <QBuffer>
+#include <QFuture>
+#include <QGuiApplication>
+#include <QImageReader>
+#include <QPixmap>
+#include <QPromise>
+#include <QScreen>
+#include <QTimer>
+#include <QtMath>
+
+#include <memory>
+#include <utility>
+
+namespace {
+
+constexpr int IconSize = 16;
+constexpr int MaxCachedIcons = 1024;
+// Lectures de petits fichiers : plus de threads n'irait pas plus vite
+constexpr int DecodeThreads = 2;
+// Un .ico malformé peut annoncer des centaines d'images
+constexpr int MaxFrames = 16;
+
+// Exécuté sur le pool : lecture de l'image et mise à l'échelle
+QList<QImage> decodeFavicon(QImageReader &reader, const QList<int> &sizes)
+{
+    QList<QImage> frames; // un .ico contient souvent plusieurs tailles
+    for (int i = 0; i < MaxFrames; ++i) {
+        const QImage frame = reader.read();
+        if (!frame.isNull())
+            frames.append(frame);
+        if (!reader.jumpToNextImage())
+            break;
+    }
+    if (frames.isEmpty())
+        return {};
+
+    QList<QImage> images;
+    for (int size : sizes) {
+        // La plus petite image suffisante, sinon la plus grande
+        const QImage *best = &frames.first();
+        for (const QImage &frame : std::as_const(frames)) {
+            const bool fits = frame.width() >= size;
+            const bool bestFits = best->width() >= size;
+            if (fits ? (!bestFits || frame.width() < best->width())
+                     : (!bestFits && frame.width() > best->width()))
+                best = &frame;
+        }
+        QImage image = best->width() == size && best->height() == size
+            ? *best
+            : best->scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        images.append(image.convertToFormat(QImage::Format_ARGB32_Premultiplied));
+    }
+    return images;
+}
+
+}
+
+FaviconCache::FaviconCache(FavoritesModel *model, FaviconStore *store, QObject *parent)
+    : QObject(parent)
+    , m_model(model)
+    , m_store(store)
+    , m_icons(MaxCachedIcons)
+{
+    m_pool.setMaxThreadCount(DecodeThreads);
+
+    // Une taille par densité d'écran présente
+    for (QScreen *screen : QGuiApplication::screens()) {
+        const int size = qCeil(IconSize * screen->devicePixelRatio());
+        if (!m_sizes.contains(size))
+            m_sizes.append(size);
+    }
+    if (m_sizes.isEmpty())
+        m_sizes.append(IconSize);
+}
+
+QIcon FaviconCache::icon(int id)
+{
+    const QString path = m_model->tree().iconPath(id);
+    if (path.isEmpty())
+        return placeholder(id);
+
+    if (const QIcon *icon = m_icons.object(path))
+        return icon->isNull() ? placeholder(id) : *icon;
+
+    auto it = m_waiting.find(path);
+    if (it == m_waiting.end()) {
+        m_waiting.insert(path, {id});
+        decode(path);
+    } else if (!it->contains(id)) {
+        it->append(id);
+    }
+    return placeholder(id);
+}
+
+void FaviconCache::reload(int id)
+{
+    const QString path = m_model->tree().iconPath(id);
+    if (path.isEmpty())
+        return;
+
+    m_icons.remove(path);
+    auto it = m_waiting.find(path);
+    if (it != m_waiting.end()) {
+        // Le décodage en cours lit peut-être l'ancien fichier
+        m_stale.insert(path);
+        if (!it->contains(id))
+            it->append(id);
+        return;
+    }
+    m_waiting.insert(path, {id});
+    decode(path);
+}
+
+void FaviconCache::decode(const QString &path)
+{
+    // Icône du store : lue avec les autres demandes du même tour de boucle
+    if (!FaviconStore::hashFromReference(path).isEmpty()) {
+        if (m_toRead.isEmpty())
+            QTimer::singleShot(0, this, &FaviconCache::readPending);
+        m_toRead.append(path);
+        return;
+    }
+    decode(path, QByteArray());
+}
+
+void FaviconCache::decode(const QString &path, const QByteArray &data)
+{
+    auto promise = std::make_shared<QPromise<QList<QImage>>>();
+    QFuture<QList<QImage>> future = promise->future();
+    // data vide : ancien favori qui désigne encore un fichier
+    m_pool.start([promise, path, data, sizes = m_sizes]() mutable {
+        promise->start();
+        QBuffer buffer(&data);
+        QImageReader reader;
+        if (data.isEmpty())
+            reader.setFileName(path);
+        else
+            reader.setDevice(&buffer);
+        promise->addResult(decodeFavicon(reader, sizes));
+        promise->finish();
+    });
+
+    future.then(this, [this, path](const QList<QImage> &images) {
+        if (m_stale.remove(path)) {
+            decode(path);
+            return;
+        }
+        finish(path, images);
+    });
+}
+
+void FaviconCache::readPending()
+{
+    const QList<QString> refs = std::exchange(m_toRead, {});
+    QList<QByteArray> hashes;
+    hashes.reserve(refs.size());
+    for (const QString &ref : refs)
+        hashes.append(FaviconStore::hashFromReference(ref));
+
+    const QHash<QByteArray, QByteArray> blobs = m_store->icons(hashes);
+    for (qsizetype i = 0; i < refs.size(); ++i) {
+        m_stale.remove(refs.at(i)); // la lecture a lieu maintenant
+        const QByteArray data = blobs.value(hashes.at(i));
+        if (data.isEmpty())
+            finish(refs.at(i), {}); // évincée : la lettre reste jusqu'au retour de l'icône
+        else
+            decode(refs.at(i), data);
+    }
+}
+
+void FaviconCache::finish(const QString &path, const QList<QImage> &images)
+{
+    // Seule étape sur le thread graphique : images prêtes -> pixmaps
+    auto *icon = new QIcon;
+    for (const QImage &image : images)
+        icon->addPixmap(QPixmap::fromImage(image));
+    const bool valid = !icon->isNull();
+    m_icons.insert(path, icon);
+
+    const QList<int> ids = m_waiting.take(path);
+    if (!valid)
+        return; // la lettre déjà affichée reste en place
+    const FavoritesTree &tree = m_model->tree();
+    for (int id : ids) {
+        if (tree.contains(id) && tree.iconPath(id) == path)
+            emit iconChanged(id);
+    }
+}
+
+QIcon FaviconCache::placeholder(int id) const
+{
+    const QString title = m_model->tree().title(id);
+    return IconCache::glyphIcon(title.isEmpty() ? QChar(u' ') : title.at(0).toUpper(), Qt::black);
+}
@@ -0,0 +1,55 @@
+#ifndef FAVICONCACHE_H
+#define FAVICONCACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QIcon>
+#include <QImage>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+
+class FaviconStore;
+class FavoritesModel;
+
+// Icônes des favoris, partagées par la barre et les menus de toutes les
+// fenêtres. Les icônes du FaviconStore sont lues par lots (une requête pour
+// toutes celles demandées dans le même tour de boucle) puis décodées sur un
+// pool de threads, directement aux tailles affichées (16 px logiques pour chaque
+// densité d'écran) ; le thread graphique ne fait que convertir les images
+// prêtes en pixmaps. En attendant, un favori affiche sa lettre.
+class FaviconCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    FaviconCache(FavoritesModel *model, FaviconStore *store, QObject *parent = nullptr);
+
+    // Favicon décodée si elle est prête, sinon la lettre du favori ;
+    // iconChanged(id) signale l'arrivée de la vraie icône
+    QIcon icon(int id);
+    // Le contenu de l'icône du favori a été réécrit : le décoder à nouveau
+    void reload(int id);
+
+signals:
+    void iconChanged(int id);
+
+private:
+    void decode(const QString &path);
+    void decode(const QString &path, const QByteArray &data);
+    void readPending();
+    void finish(const QString &path, const QList<QImage> &images);
+    QIcon placeholder(int id) const;
+
+    FavoritesModel *m_model;
+    FaviconStore *m_store;
+    QThreadPool m_pool;
+    QList<int> m_sizes; // tailles en pixels physiques
+    QCache<QString, QIcon> m_icons; // référence ou chemin -> icône (nulle si illisible)
+    QHash<QString, QList<int>> m_waiting; // décodages en cours -> favoris à prévenir
+    QSet<QString> m_stale; // réécrits pendant leur décodage
+    QList<QString> m_toRead; // références à lire au prochain lot
+};
+
+#endif // FAVICONCACHE_H
@@ -0,0 +1,310 @@
+#include "faviconfetcher.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QImage>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTimer>
+
+namespace {
+
+// Une icône récupérée reste valide un jour ; un hôte sans icône n'est
+// réinterrogé qu'au bout d'une heure
+constexpr qint64 TtlSecs = 24 * 60 * 60;
+constexpr qint64 RetrySecs = 60 * 60;
+constexpr int MaxConcurrentRequests = 4;
+constexpr int TransferTimeoutMs = 15 * 1000;
+// Le moteur annonce souvent l'icône juste après la fin du chargement
+constexpr int FallbackDelayMs = 3 * 1000;
+// Plus grande taille qu'une entrée .ico peut décrire
+constexpr int MaxStoredIconSize = 256;
+
+// Toutes les tailles fournies par la page : FaviconCache choisit ensuite la
+// plus proche de chaque taille affichée plutôt que de réduire la plus grande.
+// QIcon et QPixmap sont réservés au thread graphique : les images en sortent ici
+QList<QImage> iconImages(const QIcon &icon)
+{
+    QList<QImage> images;
+    QList<int> widths;
+    for (const QSize &available : icon.availableSizes()) {
+        if (available.width() > MaxStoredIconSize || available.height() > MaxStoredIconSize
+            || widths.contains(available.width()))
+            continue;
+        // Pixels réels, sans le facteur d'échelle de l'écran
+        const QImage image = icon.pixmap(available, 1.0).toImage();
+        if (image.isNull())
+            continue;
+        widths.append(available.width());
+        images.append(image);
+    }
+    if (images.isEmpty()) {
+        const QImage image = icon.pixmap(QSize(32, 32), 1.0).toImage();
+        if (!image.isNull())
+            images.append(image);
+    }
+    return images;
+}
+
+QByteArray encodePng(const QImage &image)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!image.save(&buffer, "PNG"))
+        return {};
+    return data;
+}
+
+// Sur le thread de travail du store. Une seule taille reste un PNG ;
+// plusieurs forment un .ico dont chaque entrée est un PNG, que le lecteur
+// ICO de Qt sait relire image par image
+QByteArray encodeIcon(const QList<QImage> &images)
+{
+    if (images.size() == 1)
+        return encodePng(images.first());
+
+    QList<QByteArray> entries;
+    for (const QImage &image : images) {
+        const QByteArray png = encodePng(image);
+        if (png.isEmpty())
+            return {};
+        entries.append(png);
+    }
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << quint16(0) << quint16(1) << quint16(entries.size());
+    quint32 offset = 6 + 16 * quint32(entries.size());
+    for (qsizetype i = 0; i < entries.size(); ++i) {
+        const QImage &image = images.at(i);
+        // 0 vaut 256 dans un en-tête .ico
+        stream << quint8(image.width() & 0xff) << quint8(image.height() & 0xff)
+               << quint8(0) << quint8(0) << quint16(1) << quint16(32)
+               << quint32(entries.at(i).size()) << offset;
+        offset += quint32(entries.at(i).size());
+    }
+    for (const QByteArray &entry : std::as_const(entries))
+        stream.writeRawData(entry.constData(), int(entry.size()));
+    return data;
+}
+
+}
+
+FaviconFetcher::FaviconFetcher(FaviconStore *store, QObject *parent)
+    : QObject(parent)
+    , m_store(store)
+{
+    m_network.setTransferTimeout(TransferTimeoutMs);
+    // Icône évincée : la prochaine icône de la page devra être réécrite
+    connect(m_store, &FaviconStore::iconsRemoved, this, [this](const QList<QByteArray> &hashes) {
+        m_pageIcons.removeIf([&hashes](QHash<QString, PageIcon>::iterator it) {
+            return hashes.contains(it.value().hash);
+        });
+    });
+}
+
+void FaviconFetcher::fetch(const QUrl &pageUrl)
+{
+    if (pageUrl.scheme() != "http" && pageUrl.scheme() != "https")
+        return;
+    const QString host = pageUrl.host();
+    if (host.isEmpty())
+        return;
+
+    // Déjà attendue pour cet hôte : la page reçoit la même réponse
+    auto pending = m_pending.find(host);
+    if (pending != m_pending.end()) {
+        if (!pending->contains(pageUrl))
+            pending->append(pageUrl);
+        return;
+    }
+
+    // L'hôte est lu sur le thread de travail du store ; les pages du même
+    // hôte chargées entre-temps attendent la même réponse
+    m_pending.insert(host, {pageUrl});
+    m_store->runOnWorker<Entry>([host](FaviconStore *store) {
+        return store->host(host);
+    }).then(this, [this, host, pageUrl](const Entry &entry) {
+        // Une icône venue d'une page est renouvelée à chaque visite : pas d'expiration
+        const qint64 age = entry.checkedAt.isValid() ? entry.checkedAt.secsTo(QDateTime::currentDateTimeUtc()) : -1;
+        if ((entry.available && entry.fromPage)
+            || (age >= 0 && age < (entry.available ? TtlSecs : RetrySecs))) {
+            notifyPending(host, entry.available ? FaviconStore::reference(entry.hash) : QString(), false);
+            return;
+        }
+        // La page a fourni son icône pendant la lecture : son écriture préviendra les pages
+        if (!m_pending.contains(host) || m_pageIcons.contains(host))
+            return;
+
+        QUrl iconUrl = pageUrl.adjusted(QUrl::RemoveUserInfo | QUrl::RemovePath | QUrl::RemoveQuery
+                                        | QUrl::RemoveFragment);
+        iconUrl.setPath("/favicon.ico");
+        m_origins.insert(host, {iconUrl, entry});
+        QTimer::singleShot(FallbackDelayMs, this, [this, host]() {
+            startFallback(host);
+        });
+    });
+}
+
+void FaviconFetcher::storePageIcon(const QUrl &pageUrl, const QIcon &icon)
+{
+    if (icon.isNull() || (pageUrl.scheme() != "http" && pageUrl.scheme() != "https"))
+        return;
+    const QString host = pageUrl.host();
+    if (host.isEmpty())
+        return;
+
+    const QList<QImage> images = iconImages(icon);
+    if (images.isEmpty())
+        return;
+
+    // Le secours n'est plus nécessaire s'il n'est pas encore parti ; une
+    // requête déjà partie est ignorée à son retour (voir handleReply)
+    if (m_origins.remove(host))
+        m_queue.removeAll(host);
+    QList<QUrl> &pages = m_pending[host];
+    if (!pages.contains(pageUrl))
+        pages.append(pageUrl);
+
+    // Chaque iconChanged, onglets en arrière-plan compris, redonne souvent
+    // la même image : l'hôte désigne déjà son empreinte, rien à écrire
+    size_t key = 0;
+    for (const QImage &image : images)
+        key = qHashBits(image.constBits(), size_t(image.sizeInBytes()), key);
+    auto known = m_pageIcons.constFind(host);
+    if (known != m_pageIcons.cend() && known->key == key) {
+        if (!known->hash.isEmpty())
+            notifyPending(host, FaviconStore::reference(known->hash), false);
+        return; // sinon l'écriture en cours préviendra les pages
+    }
+    m_pageIcons.insert(host, {key, {}});
+
+    struct Stored
+    {
+        QByteArray hash;
+        bool changed = false;
+    };
+    m_store->runOnWorker<Stored>([host, images](FaviconStore *store) {
+        Stored stored;
+        stored.hash = store->put(encodeIcon(images), &stored.changed);
+        if (stored.hash.isEmpty())
+            return stored;
+        Entry entry = store->host(host);
+        if (stored.changed || !entry.available || !entry.fromPage || entry.hash != stored.hash) {
+            entry.hash = stored.hash;
+            entry.available = true;
+            entry.fromPage = true;
+            entry.etag.clear();
+            entry.lastModified.clear();
+            entry.checkedAt = QDateTime::currentDateTimeUtc();
+            store->setHost(host, entry);
+        }
+        return stored;
+    }).then(this, [this, host, key](const Stored &stored) {
+        auto it = m_pageIcons.find(host);
+        if (it != m_pageIcons.end() && it->key == key) {
+            if (stored.hash.isEmpty())
+                m_pageIcons.erase(it);
+            else
+                it->hash = stored.hash;
+        }
+        notifyPending(host, stored.hash.isEmpty() ? QString() : FaviconStore::reference(stored.hash),
+                      stored.changed);
+    });
+}
+
+void FaviconFetcher::startFallback(const QString &host)
+{
+    // Entre-temps, la page a fourni son icône
+    if (!m_origins.contains(host) || m_queue.contains(host))
+        return;
+    m_queue.enqueue(host);
+    startNext();
+}
+
+void FaviconFetcher::startNext()
+{
+    while (m_running < MaxConcurrentRequests && !m_queue.isEmpty()) {
+        const QString host = m_queue.dequeue();
+        const Fallback fallback = m_origins.take(host);
+        QNetworkRequest request(fallback.url);
+
+        // Revalidation : 304 sans corps si l'icône n'a pas changé
+        const Entry &entry = fallback.entry;
+        if (entry.available && !entry.fromPage) {
+            if (!entry.etag.isEmpty())
+                request.setRawHeader("If-None-Match", entry.etag);
+            if (!entry.lastModified.isEmpty())
+                request.setRawHeader("If-Modified-Since", entry.lastModified);
+        }
+
+        QNetworkReply *reply = m_network.get(request);
+        ++m_running;
+        connect(reply, &QNetworkReply::finished, this, [this, reply, host]() {
+            handleReply(reply, host);
+        });
+    }
+}
+
+void FaviconFetcher::handleReply(QNetworkReply *reply, const QString &host)
+{
+    --m_running;
+    reply->deleteLater();
+
+    // La réponse est lue ici ; le décodage et les écritures se font sur le
+    // thread de travail du store
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const bool ok = reply->error() == QNetworkReply::NoError;
+    const QByteArray data = ok && status != 304 ? reply->readAll() : QByteArray();
+    const QByteArray etag = reply->rawHeader("ETag");
+    const QByteArray lastModified = reply->rawHeader("Last-Modified");
+
+    struct Result
+    {
+        Entry entry;
+        bool changed = false;
+    };
+    m_store->runOnWorker<Result>([host, ok, status, data, etag, lastModified](FaviconStore *store) {
+        Result result;
+        result.entry = store->host(host);
+        Entry &entry = result.entry;
+        if (entry.fromPage && entry.available)
+            return result; // l'icône de la page est arrivée pendant la requête et prime sur /favicon.ico
+
+        entry.checkedAt = QDateTime::currentDateTimeUtc();
+        if (ok && status == 304) {
+            // Icône inchangée : rien d'autre à écrire
+        } else if (ok) {
+            // Une page d'erreur servie avec un statut 200 n'est pas une icône
+            const QByteArray hash = QImage().loadFromData(data) ? store->put(data, &result.changed) : QByteArray();
+            if (!hash.isEmpty()) {
+                entry.hash = hash;
+                entry.fromPage = false;
+                entry.available = true;
+                entry.etag = etag;
+                entry.lastModified = lastModified;
+            } else {
+                entry.available = false;
+            }
+        } else if (status >= 400) {
+            entry.available = false; // l'hôte n'a pas (ou plus) d'icône
+        }
+        // Sinon (réseau indisponible...) l'icône déjà en cache reste utilisable
+        store->setHost(host, entry);
+        return result;
+    }).then(this, [this, host](const Result &result) {
+        notifyPending(host, result.entry.available ? FaviconStore::reference(result.entry.hash) : QString(),
+                      result.changed);
+    });
+    startNext();
+}
+
+void FaviconFetcher::notifyPending(const QString &host, const QString &ref, bool changed)
+{
+    const QList<QUrl> pages = m_pending.take(host);
+    if (ref.isEmpty())
+        return;
+    for (const QUrl &page : pages)
+        emit faviconReady(page, ref, changed);
+}
@@ -0,0 +1,82 @@
+#ifndef FAVICONFETCHER_H
+#define FAVICONFETCHER_H
+
+#include "faviconstore.h"
+
+#include <QHash>
+#include <QIcon>
+#include <QImage>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QObject>
+#include <QQueue>
+#include <QUrl>
+
+class QNetworkReply;
+
+// Favicons des sites, un seul gestionnaire par Browser. La source
+// principale est l'icône que le moteur a déjà chargée pour la page
+// (<link rel=icon> compris), rangée dans le FaviconStore en PNG, ou en .ico
+// de PNG lorsqu'elle existe en plusieurs tailles : aucune requête
+// supplémentaire. L'encodage, l'empreinte et l'écriture se font sur
+// le thread de travail du store, et seulement si l'image diffère de la
+// dernière reçue pour l'hôte. /favicon.ico n'est demandé qu'en secours, si la
+// page n'a fourni aucune icône peu après son chargement.
+//
+// Pour ce secours, toutes les requêtes passent par le même
+// QNetworkAccessManager, un hôte n'a jamais plus d'une requête en cours, le
+// nombre de requêtes simultanées est plafonné, une icône récupérée n'est pas
+// redemandée avant l'expiration de sa durée de validité, et la revalidation
+// se fait par requête conditionnelle (ETag / Last-Modified).
+class FaviconFetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FaviconFetcher(FaviconStore *store, QObject *parent = nullptr);
+
+    // Page chargée : faviconReady arrive dès la lecture de l'hôte dans le
+    // store si son icône est connue, sinon après l'icône de la page ou le
+    // téléchargement de secours
+    void fetch(const QUrl &pageUrl);
+    // Icône fournie par le moteur pour pageUrl
+    void storePageIcon(const QUrl &pageUrl, const QIcon &icon);
+
+signals:
+    // ref : référence FaviconStore de l'icône ; changed : son contenu vient
+    // d'entrer dans le store (nouvelle icône, ou revenue après éviction)
+    void faviconReady(const QUrl &pageUrl, const QString &ref, bool changed);
+
+private:
+    using Entry = FaviconStore::HostEntry;
+
+    void startFallback(const QString &host);
+    void startNext();
+    void handleReply(QNetworkReply *reply, const QString &host);
+    // ref vide : l'hôte n'a pas d'icône
+    void notifyPending(const QString &host, const QString &ref, bool changed);
+
+    // Dernière icône de page reçue pour un hôte
+    struct PageIcon
+    {
+        size_t key = 0;   // empreinte rapide des pixels
+        QByteArray hash;  // empreinte dans le store ; vide tant que l'écriture est en cours
+    };
+
+    // /favicon.ico de secours, avec ce que le store savait de l'hôte pour la revalidation
+    struct Fallback
+    {
+        QUrl url;
+        Entry entry;
+    };
+
+    FaviconStore *m_store; // icônes et validateurs HTTP, d'une session à l'autre
+    QNetworkAccessManager m_network;
+    QHash<QString, QList<QUrl>> m_pending; // hôte -> pages en attente de l'icône
+    QHash<QString, Fallback> m_origins; // hôte -> secours pas encore demandé
+    QHash<QString, PageIcon> m_pageIcons;
+    QQueue<QString> m_queue;
+    int m_running = 0;
+};
+
+#endif // FAVICONFETCHER_H
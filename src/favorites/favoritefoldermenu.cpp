@@ -0,0 +1,162 @@
+#include "favoritefoldermenu.h"
+#include "faviconcache.h"
+#include "favoritesmodel.h"
+
+namespace {
+
+// Délai avant de libérer le contenu d'un menu refermé
+constexpr int ReleaseDelayMs = 30 * 1000;
+
+}
+
+FavoriteFolderMenu::FavoriteFolderMenu(FavoritesModel *model, int folderId, FaviconCache *icons, QWidget *parent)
+    : QMenu(model->tree().title(folderId), parent)
+    , m_model(model)
+    , m_folderId(folderId)
+    , m_icons(icons)
+{
+    setIcon(QIcon(":/3rdparty/folder-closed.png"));
+    // Un menu sans entrée ne s'ouvre pas : une seule action en attendant
+    addPlaceholder(tr("Chargement..."));
+
+    m_releaseTimer.setSingleShot(true);
+    m_releaseTimer.setInterval(ReleaseDelayMs);
+    connect(&m_releaseTimer, &QTimer::timeout, this, [this]() {
+        if (!isVisible())
+            release();
+    });
+
+    connect(this, &QMenu::aboutToShow, this, &FavoriteFolderMenu::populate);
+    connect(this, &QMenu::aboutToHide, &m_releaseTimer, qOverload<>(&QTimer::start));
+
+    // Contenu arrivé de la base pendant que le menu est ouvert
+    connect(m_model, &FavoritesModel::childrenLoaded, this, [this](int id) {
+        if (id == m_folderId && !m_populated && isVisible())
+            populate();
+    });
+
+    // Une fois rempli, le menu n'applique que les écarts
+    connect(m_model, &FavoritesModel::itemInserted, this, [this](int id) {
+        if (m_populated && m_model->contains(id) && m_model->tree().parentId(id) == m_folderId)
+            insertEntry(id);
+    });
+    connect(m_model, &FavoritesModel::itemRemoved, this, [this](int id) {
+        removeEntry(id);
+    });
+    connect(m_model, &FavoritesModel::itemMoved, this, [this](int id) {
+        removeEntry(id);
+        if (m_populated && m_model->contains(id) && m_model->tree().parentId(id) == m_folderId)
+            insertEntry(id);
+    });
+    connect(m_model, &FavoritesModel::itemChanged, this, [this](int id) {
+        if (QAction *action = m_entries.value(id))
+            updateEntry(action, id);
+    });
+    connect(m_icons, &FaviconCache::iconChanged, this, [this](int id) {
+        if (QAction *action = m_entries.value(id))
+            action->setIcon(m_icons->icon(id));
+    });
+}
+
+void FavoriteFolderMenu::addPlaceholder(const QString &text)
+{
+    m_placeholder = addAction(text);
+    m_placeholder->setEnabled(false);
+}
+
+void FavoriteFolderMenu::removePlaceholder()
+{
+    if (!m_placeholder)
+        return;
+    removeAction(m_placeholder);
+    m_placeholder->deleteLater();
+    m_placeholder = nullptr;
+}
+
+QAction *FavoriteFolderMenu::insertEntry(int id)
+{
+    removePlaceholder();
+    const FavoritesTree &tree = m_model->tree();
+    // Le menu est rempli : le frère suivant a forcément son entrée
+    QAction *before = m_entries.value(tree.nextSibling(id));
+
+    QAction *action = nullptr;
+    if (tree.isFolder(id)) {
+        auto *subMenu = new FavoriteFolderMenu(m_model, id, m_icons, this);
+        connect(subMenu, &FavoriteFolderMenu::favoriteTriggered, this, &FavoriteFolderMenu::favoriteTriggered);
+        action = insertMenu(before, subMenu);
+    } else {
+        action = new QAction(this);
+        updateEntry(action, id);
+        connect(action, &QAction::triggered, this, [this, id]() {
+            if (m_model->contains(id))
+                emit favoriteTriggered(QUrl(m_model->tree().url(id)));
+        });
+        insertAction(before, action);
+    }
+    m_entries.insert(id, action);
+    return action;
+}
+
+void FavoriteFolderMenu::removeEntry(int id)
+{
+    QAction *action = m_entries.take(id);
+    if (!action)
+        return;
+    removeAction(action);
+    // L'action d'un sous-dossier appartient à son menu
+    if (QMenu *subMenu = action->menu())
+        subMenu->deleteLater();
+    else
+        action->deleteLater();
+
+    if (m_entries.isEmpty())
+        addPlaceholder(tr("Dossier vide"));
+}
+
+void FavoriteFolderMenu::updateEntry(QAction *action, int id)
+{
+    const FavoritesTree &tree = m_model->tree();
+    action->setText(tree.title(id));
+    if (tree.isFolder(id))
+        return;
+
+    const QString url = tree.url(id);
+    action->setToolTip(url);
+    action->setData(QUrl(url));
+    action->setIcon(m_icons->icon(id));
+}
+
+void FavoriteFolderMenu::populate()
+{
+    m_releaseTimer.stop();
+    if (m_populated)
+        return;
+
+    m_model->fetchChildren(m_folderId);
+    if (!m_model->isLoaded(m_folderId))
+        return; // le texte d'attente reste affiché jusqu'à childrenLoaded
+
+    clear();
+    m_placeholder = nullptr;
+    m_model->tree().forEachChild(m_folderId, [this](int childId) {
+        insertEntry(childId);
+    });
+
+    if (m_entries.isEmpty())
+        addPlaceholder(tr("Dossier vide"));
+    m_populated = true;
+}
+
+void FavoriteFolderMenu::release()
+{
+    if (!m_populated)
+        return;
+
+    // Les sous-menus ne sont pas des actions du menu : clear() ne les libère pas
+    qDeleteAll(findChildren<FavoriteFolderMenu *>(Qt::FindDirectChildrenOnly));
+    m_entries.clear();
+    clear();
+    addPlaceholder(tr("Chargement..."));
+    m_populated = false;
+}
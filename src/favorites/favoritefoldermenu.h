@@ -0,0 +1,47 @@
+#ifndef FAVORITEFOLDERMENU_H
+#define FAVORITEFOLDERMENU_H
+
+#include <QHash>
+#include <QMenu>
+#include <QTimer>
+#include <QUrl>
+
+class FaviconCache;
+class FavoritesModel;
+
+// Menu d'un dossier de favoris. Créé vide, il ne construit ses entrées qu'à
+// son ouverture (les sous-dossiers sont à leur tour des menus vides) et les
+// libère après être resté fermé un moment : le coût d'un dossier n'est payé
+// que s'il est réellement ouvert. Une fois rempli, il suit les changements
+// du modèle entrée par entrée.
+class FavoriteFolderMenu : public QMenu
+{
+    Q_OBJECT
+
+public:
+    FavoriteFolderMenu(FavoritesModel *model, int folderId, FaviconCache *icons, QWidget *parent = nullptr);
+
+    int folderId() const { return m_folderId; }
+
+signals:
+    void favoriteTriggered(const QUrl &url);
+
+private:
+    void populate();
+    void release();
+    void addPlaceholder(const QString &text);
+    void removePlaceholder();
+    QAction *insertEntry(int id);
+    void removeEntry(int id);
+    void updateEntry(QAction *action, int id);
+
+    FavoritesModel *m_model;
+    int m_folderId;
+    FaviconCache *m_icons;
+    bool m_populated = false;
+    QHash<int, QAction *> m_entries; // id -> entrée, tant que le menu est rempli
+    QAction *m_placeholder = nullptr;
+    QTimer m_releaseTimer;
+};
+
+#endif // FAVORITEFOLDERMENU_H
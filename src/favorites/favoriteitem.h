@@ -1,20 +1,22 @@
 #ifndef FAVORITEITEM_H
 #define FAVORITEITEM_H
 
-#include <QString>
-#include <QList>
-
+// Nœud de l'arène des favoris. Les liens sont des indices dans le tableau de
+// FavoritesTree (-1 : aucun) et les textes des références dans son pool de
+// chaînes : un nœud ne possède aucune mémoire, l'arbre se libère d'un bloc.
 struct FavoriteItem {
-    int id;
-    QString title;
-    QString url;
-    QString iconPath;
-    QList<FavoriteItem*> children;
-    FavoriteItem* parent;
+    int id = -1;            // identifiant en base, -1 pour un emplacement libre
+    int parent = -1;
+    int firstChild = -1;
+    int lastChild = -1;
+    int prevSibling = -1;
+    int nextSibling = -1;
+    int childCount = 0;
+    int title = 0;          // 0 : chaîne vide dans le pool
+    int url = 0;
+    int iconPath = 0;
 
-    FavoriteItem(int id = -1, QString title = "", QString url = "", QString iconPath = "",
-                 QList<FavoriteItem*> children = {}, FavoriteItem* parent = nullptr)
-        : id(id), title(title), url(url), iconPath(iconPath), children(children), parent(parent) {}
+    bool isFolder() const { return url == 0; }
 };
 
 #endif // FAVORITEITEM_H
@@ -0,0 +1,436 @@
+#include "favoritesbar.h"
+#include "faviconcache.h"
+#include "favoritefoldermenu.h"
+#include "favoritesmodel.h"
+
+#include <QApplication>
+#include <QHelpEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QStyle>
+#include <QStyleOption>
+#include <QToolTip>
+
+#include <algorithm>
+
+namespace {
+
+constexpr int IconSize = 16;
+constexpr int IconSpacing = 4;
+constexpr int HorizontalPadding = 6;
+constexpr int VerticalPadding = 4;
+constexpr int ItemSpacing = 2;
+constexpr int MaxTextWidth = 160;
+constexpr int ChevronWidth = IconSize + 2 * HorizontalPadding;
+constexpr int ChevronIndex = -2; // survol du chevron
+
+}
+
+FavoritesBar::FavoritesBar(FavoritesModel *model, FaviconCache *icons, QWidget *parent)
+    : QWidget(parent)
+    , m_model(model)
+    , m_icons(icons)
+    , m_folderIcon(":/3rdparty/folder-closed.png")
+    , m_moreIcon(":/icons/more.png")
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    setMouseTracking(true);
+
+    connect(m_model, &FavoritesModel::modelReset, this, [this]() {
+        m_widths.clear();
+        reload();
+    });
+    // Seul le premier niveau est affiché : le reste ne concerne que les menus
+    connect(m_model, &FavoritesModel::itemInserted, this, [this](int id) {
+        if (m_model->contains(id) && m_model->tree().parentId(id) == FavoritesModel::RootId)
+            reload();
+    });
+    connect(m_model, &FavoritesModel::itemRemoved, this, [this](int id, int parentId) {
+        if (parentId != FavoritesModel::RootId)
+            return;
+        m_widths.remove(id);
+        reload();
+    });
+    connect(m_model, &FavoritesModel::itemMoved, this, [this](int id, int oldParentId) {
+        if (oldParentId == FavoritesModel::RootId
+            || (m_model->contains(id) && m_model->tree().parentId(id) == FavoritesModel::RootId))
+            reload();
+    });
+    connect(m_model, &FavoritesModel::itemChanged, this, [this](int id) {
+        if (m_widths.contains(id))
+            invalidate(id);
+    });
+    // Favicon décodée : seul le favori concerné est redessiné
+    connect(m_icons, &FaviconCache::iconChanged, this, [this](int id) {
+        updateVisibleCount();
+        const auto end = m_ids.cbegin() + m_visibleCount;
+        const auto it = std::find(m_ids.cbegin(), end, id);
+        if (it != end)
+            update(itemRect(int(it - m_ids.cbegin())));
+    });
+
+    reload();
+}
+
+int FavoritesBar::favoriteAt(const QPoint &pos) const
+{
+    if (!rect().contains(pos))
+        return -1;
+    const int index = indexAt(pos.x());
+    return index == -1 ? -1 : m_ids.at(index);
+}
+
+QSize FavoritesBar::sizeHint() const
+{
+    ensureOffsets();
+    return QSize(m_offsets.last() + ChevronWidth, minimumSizeHint().height());
+}
+
+QSize FavoritesBar::minimumSizeHint() const
+{
+    return QSize(ChevronWidth, qMax(IconSize, fontMetrics().height()) + 2 * VerticalPadding);
+}
+
+void FavoritesBar::reload()
+{
+    m_ids = m_model->tree().children(FavoritesModel::RootId);
+    m_offsetsDirty = true;
+    m_hoverIndex = -1;
+    resetDrag();
+    updateGeometry();
+    update();
+}
+
+void FavoritesBar::invalidate(int id)
+{
+    const int oldWidth = m_widths.take(id);
+    const qsizetype index = m_ids.indexOf(id);
+    if (index == -1 || m_offsetsDirty)
+        return; // remesuré avec les autres à la prochaine mise en page
+
+    updateVisibleCount();
+    const bool wasVisible = index < m_visibleCount;
+    // Seul ce favori est remesuré ; les abscisses qui le suivent sont décalées
+    const int delta = itemWidth(id) - oldWidth;
+    if (delta != 0) {
+        for (qsizetype i = index + 1; i < m_offsets.size(); ++i)
+            m_offsets[i] += delta;
+        m_visibleDirty = true;
+        updateGeometry();
+        updateVisibleCount();
+    }
+    if (!wasVisible && index >= m_visibleCount)
+        return;
+    // Le favori, et ceux qui le suivent si sa largeur a changé
+    const QRect rect = itemRect(int(index));
+    update(delta == 0 ? rect : QRect(rect.left(), 0, width() - rect.left(), height()));
+}
+
+void FavoritesBar::ensureOffsets() const
+{
+    if (!m_offsetsDirty)
+        return;
+    m_offsets.resize(m_ids.size() + 1);
+    m_offsets[0] = ItemSpacing;
+    for (qsizetype i = 0; i < m_ids.size(); ++i)
+        m_offsets[i + 1] = m_offsets[i] + itemWidth(m_ids.at(i)) + ItemSpacing;
+    m_offsetsDirty = false;
+    m_visibleDirty = true;
+}
+
+void FavoritesBar::updateVisibleCount() const
+{
+    ensureOffsets();
+    if (!m_visibleDirty)
+        return;
+    // Nombre de favoris dont la fin tient avant le chevron
+    const int available = width() - ChevronWidth + ItemSpacing;
+    m_visibleCount = int(std::upper_bound(m_offsets.cbegin() + 1, m_offsets.cend(), available)
+                         - (m_offsets.cbegin() + 1));
+    m_visibleDirty = false;
+}
+
+int FavoritesBar::itemWidth(int id) const
+{
+    auto it = m_widths.constFind(id);
+    if (it != m_widths.constEnd())
+        return it.value();
+
+    int width = 2 * HorizontalPadding + IconSize;
+    const QString title = m_model->tree().title(id);
+    if (!title.isEmpty())
+        width += IconSpacing + qMin(fontMetrics().horizontalAdvance(title), MaxTextWidth);
+    m_widths.insert(id, width);
+    return width;
+}
+
+QIcon FavoritesBar::itemIcon(int id) const
+{
+    if (m_model->tree().isFolder(id))
+        return m_folderIcon;
+    return m_icons->icon(id);
+}
+
+int FavoritesBar::indexAt(int x) const
+{
+    updateVisibleCount();
+    const auto end = m_offsets.cbegin() + m_visibleCount + 1;
+    const int index = int(std::upper_bound(m_offsets.cbegin(), end, x) - m_offsets.cbegin()) - 1;
+    if (index < 0 || index >= m_visibleCount)
+        return -1;
+    // L'espace entre deux favoris n'appartient à personne
+    return x < m_offsets[index + 1] - ItemSpacing ? index : -1;
+}
+
+int FavoritesBar::dropSlotAt(int x) const
+{
+    updateVisibleCount();
+    if (x >= m_offsets[m_visibleCount])
+        return m_visibleCount;
+    const int index = qMax(0, int(std::upper_bound(m_offsets.cbegin(), m_offsets.cbegin() + m_visibleCount + 1, x)
+                                  - m_offsets.cbegin()) - 1);
+    return x < (m_offsets[index] + m_offsets[index + 1]) / 2 ? index : index + 1;
+}
+
+QRect FavoritesBar::itemRect(int index) const
+{
+    ensureOffsets();
+    return QRect(m_offsets[index], 0, m_offsets[index + 1] - m_offsets[index] - ItemSpacing, height());
+}
+
+QRect FavoritesBar::chevronRect() const
+{
+    return QRect(width() - ChevronWidth, 0, ChevronWidth, height());
+}
+
+bool FavoritesBar::event(QEvent *event)
+{
+    if (event->type() != QEvent::ToolTip)
+        return QWidget::event(event);
+
+    auto *helpEvent = static_cast<QHelpEvent *>(event);
+    const int index = indexAt(helpEvent->pos().x());
+    if (index != -1) {
+        const int id = m_ids.at(index);
+        const FavoritesTree &tree = m_model->tree();
+        QToolTip::showText(helpEvent->globalPos(), tree.isFolder(id) ? tree.title(id) : tree.url(id),
+                           this, itemRect(index));
+    } else if (!m_ids.isEmpty() && chevronRect().contains(helpEvent->pos())) {
+        QToolTip::showText(helpEvent->globalPos(), tr("Autres favoris"), this, chevronRect());
+    } else {
+        QToolTip::hideText();
+        event->ignore();
+    }
+    return true;
+}
+
+void FavoritesBar::paintEvent(QPaintEvent *event)
+{
+    updateVisibleCount();
+    QPainter painter(this);
+    const QFontMetrics metrics = fontMetrics();
+    const FavoritesTree &tree = m_model->tree();
+
+    auto drawPanel = [this, &painter](const QRect &rect, bool sunken) {
+        QStyleOption option;
+        option.initFrom(this);
+        option.rect = rect;
+        option.state |= QStyle::State_AutoRaise | QStyle::State_MouseOver
+                        | (sunken ? QStyle::State_Sunken : QStyle::State_Raised);
+        style()->drawPrimitive(QStyle::PE_PanelButtonTool, &option, &painter, this);
+    };
+
+    // Seuls les favoris visibles sont parcourus : leur nombre est borné
+    // par la largeur de la barre, pas par le nombre de favoris
+    for (int i = 0; i < m_visibleCount; ++i) {
+        const QRect rect = itemRect(i);
+        if (!rect.intersects(event->rect()))
+            continue;
+        const int id = m_ids.at(i);
+
+        if (i == m_hoverIndex || (i == m_pressIndex && !m_dragging))
+            drawPanel(rect, i == m_pressIndex && !m_dragging);
+
+        const QRect iconRect(rect.left() + HorizontalPadding, rect.center().y() - IconSize / 2 + 1,
+                             IconSize, IconSize);
+        itemIcon(id).paint(&painter, iconRect);
+
+        const QRect textRect = rect.adjusted(HorizontalPadding + IconSize + IconSpacing, 0, -HorizontalPadding, 0);
+        if (textRect.width() > 0) {
+            painter.setPen(palette().color(QPalette::ButtonText));
+            painter.drawText(textRect, Qt::AlignVCenter | Qt::AlignLeft,
+                             metrics.elidedText(tree.title(id), Qt::ElideRight, textRect.width()));
+        }
+    }
+
+    if (!m_ids.isEmpty()) {
+        const QRect rect = chevronRect();
+        if (m_hoverIndex == ChevronIndex || m_chevronPressed)
+            drawPanel(rect, m_chevronPressed);
+        m_moreIcon.paint(&painter, QRect(rect.center().x() - IconSize / 2 + 1, rect.center().y() - IconSize / 2 + 1,
+                                       IconSize, IconSize));
+    }
+
+    if (m_dragging && m_dropSlot != -1) {
+        const int x = m_offsets[m_dropSlot] - ItemSpacing / 2 - 1;
+        painter.fillRect(QRect(x, VerticalPadding, 2, height() - 2 * VerticalPadding),
+                         palette().color(QPalette::Highlight));
+    }
+}
+
+void FavoritesBar::resizeEvent(QResizeEvent *event)
+{
+    // Les largeurs ne changent pas : seul le point de coupure est recalculé
+    m_visibleDirty = true;
+    QWidget::resizeEvent(event);
+}
+
+void FavoritesBar::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::FontChange || event->type() == QEvent::StyleChange) {
+        m_widths.clear();
+        m_offsetsDirty = true;
+        updateGeometry();
+        update();
+    }
+    QWidget::changeEvent(event);
+}
+
+void FavoritesBar::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton) {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+
+    const QPoint pos = event->position().toPoint();
+    if (!m_ids.isEmpty() && chevronRect().contains(pos)) {
+        showOverflowMenu();
+        return;
+    }
+    m_pressIndex = indexAt(pos.x());
+    m_pressPos = pos;
+    update();
+}
+
+void FavoritesBar::mouseMoveEvent(QMouseEvent *event)
+{
+    const QPoint pos = event->position().toPoint();
+    if (m_pressIndex != -1 && (event->buttons() & Qt::LeftButton)) {
+        if (!m_dragging && (pos - m_pressPos).manhattanLength() >= QApplication::startDragDistance()) {
+            m_dragging = true;
+            setCursor(Qt::ClosedHandCursor);
+        }
+        if (m_dragging) {
+            const int slot = dropSlotAt(pos.x());
+            if (slot != m_dropSlot) {
+                m_dropSlot = slot;
+                update();
+            }
+        }
+        return;
+    }
+
+    int hover = indexAt(pos.x());
+    if (hover == -1 && !m_ids.isEmpty() && chevronRect().contains(pos))
+        hover = ChevronIndex;
+    setHoverIndex(hover);
+}
+
+void FavoritesBar::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton || m_pressIndex == -1) {
+        QWidget::mouseReleaseEvent(event);
+        return;
+    }
+
+    const int from = m_pressIndex;
+    if (m_dragging) {
+        // Le rang visé se compte sans le favori déplacé
+        const int slot = dropSlotAt(event->position().toPoint().x());
+        if (slot != from && slot != from + 1)
+            m_model->moveFavorite(m_ids.at(from), FavoritesModel::RootId, slot > from ? slot - 1 : slot);
+        resetDrag();
+    } else {
+        resetDrag();
+        if (indexAt(event->position().toPoint().x()) == from)
+            activate(from);
+    }
+}
+
+void FavoritesBar::leaveEvent(QEvent *event)
+{
+    setHoverIndex(-1);
+    QWidget::leaveEvent(event);
+}
+
+void FavoritesBar::activate(int index)
+{
+    const int id = m_ids.at(index);
+    const FavoritesTree &tree = m_model->tree();
+    if (!tree.isFolder(id)) {
+        emit favoriteTriggered(QUrl(tree.url(id)));
+        return;
+    }
+
+    // Le menu du dossier n'existe que le temps de son ouverture
+    auto *menu = new FavoriteFolderMenu(m_model, id, m_icons, this);
+    connect(menu, &FavoriteFolderMenu::favoriteTriggered, this, &FavoritesBar::favoriteTriggered);
+    connect(menu, &QMenu::aboutToHide, menu, &QObject::deleteLater);
+    menu->popup(mapToGlobal(itemRect(index).bottomLeft()));
+}
+
+void FavoritesBar::showOverflowMenu()
+{
+    updateVisibleCount();
+    auto *menu = new QMenu(this);
+    const FavoritesTree &tree = m_model->tree();
+
+    // Construit à l'ouverture, avec les seuls favoris qui ne tiennent pas
+    for (qsizetype i = m_visibleCount; i < m_ids.size(); ++i) {
+        const int id = m_ids.at(i);
+        if (tree.isFolder(id)) {
+            auto *subMenu = new FavoriteFolderMenu(m_model, id, m_icons, menu);
+            connect(subMenu, &FavoriteFolderMenu::favoriteTriggered, this, &FavoritesBar::favoriteTriggered);
+            menu->addMenu(subMenu);
+            continue;
+        }
+        QAction *action = menu->addAction(itemIcon(id), tree.title(id));
+        action->setToolTip(tree.url(id));
+        connect(action, &QAction::triggered, this, [this, id]() {
+            if (m_model->contains(id))
+                emit favoriteTriggered(QUrl(m_model->tree().url(id)));
+        });
+    }
+    if (!menu->isEmpty())
+        menu->addSeparator();
+    connect(menu->addAction(m_moreIcon, tr("Voir plus...")), &QAction::triggered,
+            this, &FavoritesBar::moreRequested);
+
+    m_chevronPressed = true;
+    update(chevronRect());
+    connect(menu, &QMenu::aboutToHide, this, [this, menu]() {
+        m_chevronPressed = false;
+        update(chevronRect());
+        menu->deleteLater();
+    });
+    menu->popup(mapToGlobal(chevronRect().bottomLeft()));
+}
+
+void FavoritesBar::setHoverIndex(int index)
+{
+    if (index == m_hoverIndex)
+        return;
+    m_hoverIndex = index;
+    update();
+}
+
+void FavoritesBar::resetDrag()
+{
+    if (m_dragging)
+        unsetCursor();
+    m_pressIndex = -1;
+    m_dragging = false;
+    m_dropSlot = -1;
+    update();
+}
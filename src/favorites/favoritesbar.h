@@ -0,0 +1,88 @@
+#ifndef FAVORITESBAR_H
+#define FAVORITESBAR_H
+
+#include <QHash>
+#include <QIcon>
+#include <QList>
+#include <QUrl>
+#include <QVector>
+#include <QWidget>
+
+class FaviconCache;
+class FavoritesModel;
+
+// Barre des favoris dessinée d'un bloc à partir du modèle : aucun QAction
+// ni bouton par favori. Les largeurs mesurées sont gardées par identifiant et
+// cumulées dans un tableau d'abscisses ; un redimensionnement ne fait qu'une
+// recherche dichotomique pour savoir où couper, quel que soit le nombre de
+// favoris. Ce qui ne tient pas passe dans le menu du chevron, construit à
+// l'ouverture seulement. Clics, survol et glisser-déposer se font par
+// recherche dans ce même tableau.
+class FavoritesBar : public QWidget
+{
+    Q_OBJECT
+
+public:
+    FavoritesBar(FavoritesModel *model, FaviconCache *icons, QWidget *parent = nullptr);
+
+    // Favori de premier niveau sous pos, -1 s'il n'y en a pas
+    int favoriteAt(const QPoint &pos) const;
+
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+
+signals:
+    void favoriteTriggered(const QUrl &url);
+    void moreRequested();
+
+protected:
+    bool event(QEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *event) override;
+
+private:
+    void reload();
+    // Titre ou icône changé : remesure ce seul favori
+    void invalidate(int id);
+    void ensureOffsets() const;
+    void updateVisibleCount() const;
+    int itemWidth(int id) const;
+    QIcon itemIcon(int id) const;
+    int indexAt(int x) const;
+    int dropSlotAt(int x) const;
+    QRect itemRect(int index) const;
+    QRect chevronRect() const;
+    void activate(int index);
+    void showOverflowMenu();
+    void setHoverIndex(int index);
+    void resetDrag();
+
+    FavoritesModel *m_model;
+    FaviconCache *m_icons;
+    // Membres plutôt que statiques : détruits avant l'application graphique
+    QIcon m_folderIcon;
+    QIcon m_moreIcon;
+    QList<int> m_ids; // premier niveau, dans l'ordre du modèle
+
+    // Cache de mise en page : m_offsets[i] est l'abscisse de début du
+    // favori i, m_offsets[m_ids.size()] la fin du dernier
+    mutable QHash<int, int> m_widths;
+    mutable QVector<int> m_offsets;
+    mutable bool m_offsetsDirty = true;
+    mutable int m_visibleCount = 0;
+    mutable bool m_visibleDirty = true;
+
+    int m_hoverIndex = -1;
+    int m_pressIndex = -1;
+    bool m_chevronPressed = false;
+    QPoint m_pressPos;
+    bool m_dragging = false;
+    int m_dropSlot = -1;
+};
+
+#endif // FAVORITESBAR_H
@@ -1,21 +1,32 @@
-#include "browserwindow.h"
 #include "favoritesmanager.h"
-#include "favoriteitem.h"
+#include "faviconcache.h"
+#include "favoritesmodel.h"
 #include <QVBoxLayout>
 #include <QPushButton>
-#include <QFile>
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonObject>
+#include <QFileDialog>
 #include <QInputDialog>
 #include <QMessageBox>
 #include <QLabel>
 #include <QDropEvent>
 #include <QMenu>
-#include <QDir>
 
-FavoritesManager::FavoritesManager(QWidget *parent)
+namespace {
+
+constexpr int IdRole = Qt::UserRole;
+// Enfant provisoire d'un dossier pas encore lu, pour afficher la flèche
+constexpr int PlaceholderRole = Qt::UserRole + 1;
+
+bool hasPlaceholder(const QStandardItem *item)
+{
+    return item->rowCount() == 1 && item->child(0)->data(PlaceholderRole).toBool();
+}
+
+}
+
+FavoritesManager::FavoritesManager(FavoritesModel *model, FaviconCache *icons, QWidget *parent)
     : QDialog(parent)
+    , m_model(model)
+    , m_icons(icons)
 {
     setWindowTitle(tr("Gérer les favoris"));
     resize(400, 300);
@@ -24,26 +35,25 @@ FavoritesManager::FavoritesManager(QWidget *parent)
     m_favoritesTree = new QTreeView(this);
     m_favoritesModel = new QStandardItemModel(this);
     m_favoritesTree->setModel(m_favoritesModel);
+    m_favoritesTree->setSelectionMode(QAbstractItemView::SingleSelection);
     m_favoritesTree->setDragEnabled(true);
     m_favoritesTree->setAcceptDrops(true);
     m_favoritesTree->setDropIndicatorShown(true);
     m_favoritesTree->setDragDropMode(QAbstractItemView::InternalMove);
+    // Le dépôt est traduit en déplacement dans le modèle (voir handleDrop)
+    m_favoritesTree->viewport()->installEventFilter(this);
 
-    m_favoritesModel->setItemPrototype(new QStandardItem);
-    m_favoritesModel->setHorizontalHeaderLabels({tr("Nom"), tr("URL"), tr("Tags")});
+    m_favoritesModel->setHorizontalHeaderLabels({tr("Nom"), tr("URL")});
     layout->addWidget(m_favoritesTree);
 
 
     QHBoxLayout *editLayout = new QHBoxLayout;
     m_nameEdit = new QLineEdit(this);
     m_urlEdit = new QLineEdit(this);
-    m_tagsEdit = new QLineEdit(this);
     editLayout->addWidget(new QLabel(tr("Nom:")));
     editLayout->addWidget(m_nameEdit);
     editLayout->addWidget(new QLabel(tr("URL:")));
     editLayout->addWidget(m_urlEdit);
-    editLayout->addWidget(new QLabel(tr("Tags:")));
-    editLayout->addWidget(m_tagsEdit);
     layout->addLayout(editLayout);
 
     QHBoxLayout *buttonLayout = new QHBoxLayout;
@@ -57,193 +67,295 @@ FavoritesManager::FavoritesManager(QWidget *parent)
     buttonLayout->addWidget(editButton);
     layout->addLayout(buttonLayout);
 
+    QHBoxLayout *exchangeLayout = new QHBoxLayout;
+    QPushButton *importButton = new QPushButton(tr("Importer..."), this);
+    QPushButton *exportButton = new QPushButton(tr("Exporter..."), this);
+    exchangeLayout->addStretch();
+    exchangeLayout->addWidget(importButton);
+    exchangeLayout->addWidget(exportButton);
+    layout->addLayout(exchangeLayout);
+
     connect(addFolderButton, &QPushButton::clicked, this, &FavoritesManager::addFolder);
     connect(addFavoriteButton, &QPushButton::clicked, this, &FavoritesManager::addFavorite);
     connect(deleteButton, &QPushButton::clicked, this, &FavoritesManager::deleteFavorite);
     connect(editButton, &QPushButton::clicked, this, &FavoritesManager::editFavorite);
+    connect(importButton, &QPushButton::clicked, this, &FavoritesManager::importFavorites);
+    connect(exportButton, &QPushButton::clicked, this, &FavoritesManager::exportFavorites);
 
     connect(m_favoritesTree, &QTreeView::customContextMenuRequested, this, &FavoritesManager::showContextMenu);
     m_favoritesTree->setContextMenuPolicy(Qt::CustomContextMenu);
 
-    loadFavorites();
+    // Champs d'édition remplis depuis l'élément sélectionné
+    connect(m_favoritesTree->selectionModel(), &QItemSelectionModel::currentChanged, this, [this]() {
+        const int id = currentId();
+        const bool valid = id != FavoritesModel::RootId && m_model->contains(id);
+        m_nameEdit->setText(valid ? m_model->tree().title(id) : QString());
+        m_urlEdit->setText(valid ? m_model->tree().url(id) : QString());
+    });
+
+    connect(m_favoritesTree, &QTreeView::expanded, this, [this](const QModelIndex &index) {
+        const int id = index.data(IdRole).toInt();
+        if (m_model->isLoaded(id))
+            populate(id);
+        else
+            m_model->fetchChildren(id);
+    });
+
+    connect(m_model, &FavoritesModel::modelReset, this, &FavoritesManager::reload);
+    connect(m_model, &FavoritesModel::childrenLoaded, this, &FavoritesManager::populate);
+    connect(m_model, &FavoritesModel::itemInserted, this, &FavoritesManager::insertItem);
+    connect(m_model, &FavoritesModel::itemRemoved, this, [this](int id) {
+        removeItem(id);
+    });
+    connect(m_model, &FavoritesModel::itemMoved, this, [this](int id) {
+        removeItem(id);
+        insertItem(id);
+    });
+    connect(m_model, &FavoritesModel::itemChanged, this, &FavoritesManager::updateItem);
+    connect(m_icons, &FaviconCache::iconChanged, this, [this](int id) {
+        if (QStandardItem *item = m_items.value(id))
+            item->setIcon(m_icons->icon(id));
+    });
+
+    reload();
 }
 
-void FavoritesManager::loadFavorites()
+void FavoritesManager::reload()
 {
-    m_favoritesModel->clear();
-    createDefaultFolder();
-
-    QString filePath = QDir::currentPath() + "/src/favorites/favorites.json";
-    QFile file(filePath);
-    if (!file.exists()) {
-        QDir().mkpath(QFileInfo(filePath).path());
-        if (file.open(QIODevice::WriteOnly)) {
-            file.write("[]");
-            file.close();
-        }
-    }
-    if (file.open(QIODevice::ReadOnly)) {
-        QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-        QJsonArray favoritesArray = doc.array();
-        loadFavoritesRecursive(favoritesArray, m_favoritesModel->item(0));
-        file.close();
-    }
+    m_items.clear();
+    m_favoritesModel->removeRows(0, m_favoritesModel->rowCount());
+    if (!m_model->isLoaded(FavoritesModel::RootId))
+        return; // modelReset suivra
+
+    m_model->tree().forEachChild(FavoritesModel::RootId, [this](int id) {
+        m_favoritesModel->appendRow(createRow(id));
+    });
 }
 
-
-void FavoritesManager::dropEvent(QDropEvent *event)
+void FavoritesManager::populate(int folderId)
 {
-    QModelIndex dropIndex = m_favoritesTree->indexAt(event->position().toPoint());
-    QStandardItem* dropItem = m_favoritesModel->itemFromIndex(dropIndex);
-    QList<QStandardItem*> draggedItems;
-
-    for (const QModelIndex &index : m_favoritesTree->selectionModel()->selectedIndexes()) {
-        if (index.column() == 0) {
-            draggedItems << m_favoritesModel->itemFromIndex(index)->clone();
-        }
-    }
+    QStandardItem *folder = m_items.value(folderId);
+    if (!folder || !hasPlaceholder(folder) || !m_model->isLoaded(folderId))
+        return;
+
+    folder->removeRow(0);
+    m_model->tree().forEachChild(folderId, [this, folder](int id) {
+        folder->appendRow(createRow(id));
+    });
+}
 
-    for (QStandardItem* item : draggedItems) {
-        if (dropItem && dropItem->data(Qt::UserRole) == "folder") {
-            dropItem->appendRow(item);
+QList<QStandardItem *> FavoritesManager::createRow(int id)
+{
+    const FavoritesTree &tree = m_model->tree();
+    auto *name = new QStandardItem(tree.title(id));
+    auto *url = new QStandardItem(tree.url(id));
+    name->setData(id, IdRole);
+    url->setData(id, IdRole);
+    url->setDropEnabled(false);
+    m_items.insert(id, name);
+
+    if (!tree.isFolder(id)) {
+        name->setIcon(m_icons->icon(id));
+        name->setDropEnabled(false);
+    } else {
+        name->setIcon(QIcon(":/3rdparty/folder-closed.png"));
+        if (m_model->isLoaded(id)) {
+            tree.forEachChild(id, [this, name](int childId) {
+                name->appendRow(createRow(childId));
+            });
         } else {
-            m_favoritesModel->appendRow(item);
+            auto *placeholder = new QStandardItem(tr("Chargement..."));
+            placeholder->setData(true, PlaceholderRole);
+            placeholder->setEnabled(false);
+            name->appendRow(placeholder);
         }
     }
+    return {name, url};
+}
 
-    for (const QModelIndex &index : m_favoritesTree->selectionModel()->selectedIndexes()) {
-        if (index.column() == 0) {
-            m_favoritesModel->removeRow(index.row(), index.parent());
+void FavoritesManager::insertItem(int id)
+{
+    if (m_items.contains(id) || !m_model->contains(id))
+        return;
+
+    // Un dossier pas encore déplié recevra ce favori en même temps que les autres
+    const FavoritesTree &tree = m_model->tree();
+    QStandardItem *parent = itemFor(tree.parentId(id));
+    if (!parent || hasPlaceholder(parent))
+        return;
+    parent->insertRow(tree.rowOf(id), createRow(id));
+}
+
+void FavoritesManager::removeItem(int id)
+{
+    QStandardItem *item = m_items.value(id);
+    if (!item)
+        return;
+
+    // Les descendants affichés quittent l'index avec leur dossier
+    QList<QStandardItem *> pending = {item};
+    while (!pending.isEmpty()) {
+        QStandardItem *current = pending.takeLast();
+        m_items.remove(current->data(IdRole).toInt());
+        for (int row = 0; row < current->rowCount(); ++row) {
+            if (QStandardItem *child = current->child(row); !child->data(PlaceholderRole).toBool())
+                pending.append(child);
         }
     }
-    saveFavorites();
-    event->acceptProposedAction();
+
+    QStandardItem *parent = item->parent() ? item->parent() : m_favoritesModel->invisibleRootItem();
+    parent->removeRow(item->row());
+}
+
+void FavoritesManager::updateItem(int id)
+{
+    QStandardItem *item = m_items.value(id);
+    if (!item || !m_model->contains(id))
+        return;
+
+    const FavoritesTree &tree = m_model->tree();
+    item->setText(tree.title(id));
+    QStandardItem *parent = item->parent() ? item->parent() : m_favoritesModel->invisibleRootItem();
+    if (QStandardItem *url = parent->child(item->row(), 1))
+        url->setText(tree.url(id));
+    if (!tree.isFolder(id))
+        item->setIcon(m_icons->icon(id));
 }
 
+QStandardItem *FavoritesManager::itemFor(int id) const
+{
+    if (id == FavoritesModel::RootId)
+        return m_favoritesModel->invisibleRootItem();
+    return m_items.value(id);
+}
 
-void FavoritesManager::loadFavoritesRecursive(const QJsonArray& array, QStandardItem* parent)
+int FavoritesManager::currentId() const
 {
-    for (const QJsonValue &value : array) {
-        QJsonObject obj = value.toObject();
-        QList<QStandardItem*> items;
-        items << new QStandardItem(obj["name"].toString());
-        items << new QStandardItem(obj["url"].toString());
-        items << new QStandardItem(obj["tags"].toString());
-        parent->appendRow(items);
-
-        if (obj.contains("children")) {
-            loadFavoritesRecursive(obj["children"].toArray(), items[0]);
+    const QModelIndex index = m_favoritesTree->currentIndex();
+    if (!index.isValid() || index.data(PlaceholderRole).toBool())
+        return FavoritesModel::RootId;
+    return index.data(IdRole).toInt();
+}
+
+int FavoritesManager::currentFolder() const
+{
+    // Le dossier sélectionné, ou celui du favori sélectionné
+    const int id = currentId();
+    if (!m_model->contains(id))
+        return FavoritesModel::RootId;
+    return m_model->tree().isFolder(id) ? id : m_model->tree().parentId(id);
+}
+
+bool FavoritesManager::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_favoritesTree->viewport() && event->type() == QEvent::Drop)
+        return handleDrop(static_cast<QDropEvent *>(event));
+    return QDialog::eventFilter(watched, event);
+}
+
+bool FavoritesManager::handleDrop(QDropEvent *event)
+{
+    const int id = currentId();
+    if (event->source() != m_favoritesTree || id == FavoritesModel::RootId || !m_model->contains(id))
+        return false;
+
+    const FavoritesTree &tree = m_model->tree();
+    const QPoint pos = event->position().toPoint();
+    const QModelIndex target = m_favoritesTree->indexAt(pos);
+    const int targetId = target.isValid() ? target.data(IdRole).toInt() : FavoritesModel::RootId;
+
+    int parentId = FavoritesModel::RootId;
+    int row = -1;
+    if (targetId != FavoritesModel::RootId && tree.contains(targetId)) {
+        // Même découpage que l'indicateur de QTreeView : bords = entre deux
+        // éléments, milieu d'un dossier = dedans
+        const QRect rect = m_favoritesTree->visualRect(target);
+        const int margin = qBound(2, rect.height() / 4, 12);
+        const bool onFolder = tree.isFolder(targetId)
+                              && pos.y() >= rect.top() + margin && pos.y() <= rect.bottom() - margin;
+        if (onFolder) {
+            parentId = targetId;
+        } else {
+            parentId = tree.parentId(targetId);
+            row = tree.rowOf(targetId) + (pos.y() > rect.center().y() ? 1 : 0);
+            // moveFavorite compte les rangs sans le favori déplacé
+            if (tree.parentId(id) == parentId && tree.rowOf(id) < row)
+                --row;
         }
     }
+
+    if (targetId != id)
+        m_model->moveFavorite(id, parentId, row);
+
+    // La vue ne déplace rien elle-même : itemMoved s'en charge
+    event->setDropAction(Qt::IgnoreAction);
+    event->accept();
+    return true;
 }
 
 void FavoritesManager::addFolder()
 {
     QString folderName = QInputDialog::getText(this, tr("Nouveau dossier"), tr("Nom du dossier:"));
-    if (!folderName.isEmpty()) {
-        QStandardItem *folder = new QStandardItem(folderName);
-        folder->setData("folder", Qt::UserRole);
-        QModelIndex index = m_favoritesTree->currentIndex();
-        if (index.isValid()) {
-            m_favoritesModel->itemFromIndex(index)->appendRow(folder);
-        } else {
-            m_favoritesModel->appendRow(folder);
-        }
-        saveFavorites();
-    }
+    if (!folderName.isEmpty())
+        m_model->addFolder(folderName, currentFolder());
 }
 
 void FavoritesManager::addFavorite()
 {
     if (!m_nameEdit->text().isEmpty() && !m_urlEdit->text().isEmpty()) {
-        QList<QStandardItem*> items;
-        items << new QStandardItem(m_nameEdit->text());
-        items << new QStandardItem(m_urlEdit->text());
-        items << new QStandardItem(m_tagsEdit->text());
-        QModelIndex index = m_favoritesTree->currentIndex();
-        if (index.isValid()) {
-            m_favoritesModel->itemFromIndex(index)->appendRow(items);
-        } else {
-            m_favoritesModel->appendRow(items);
-        }
-        saveFavorites();
+        m_model->addFavorite(m_nameEdit->text(), m_urlEdit->text(), QString(), currentFolder());
         m_nameEdit->clear();
         m_urlEdit->clear();
-        m_tagsEdit->clear();
     }
 }
 
 void FavoritesManager::deleteFavorite()
 {
-    QModelIndex index = m_favoritesTree->currentIndex();
-    if (index.isValid()) {
-        m_favoritesModel->removeRow(index.row(), index.parent());
-        saveFavorites();
-    }
+    const int id = currentId();
+    if (id != FavoritesModel::RootId)
+        m_model->removeFavorite(id);
 }
 
 void FavoritesManager::editFavorite()
 {
-    QModelIndex index = m_favoritesTree->currentIndex();
-    if (index.isValid()) {
-        m_favoritesModel->setData(index, m_nameEdit->text());
-        m_favoritesModel->setData(index.sibling(index.row(), 1), m_urlEdit->text());
-        m_favoritesModel->setData(index.sibling(index.row(), 2), m_tagsEdit->text());
-        saveFavorites();
-    }
-}
-void FavoritesManager::saveFavorites()
-{
-    QJsonArray favoritesArray;
-    saveFavoritesRecursive(m_favoritesModel->invisibleRootItem(), favoritesArray);
-
-    QFile file("src/favorites/favorites.json");
-    if (file.open(QIODevice::WriteOnly)) {
-        QJsonDocument saveDoc(favoritesArray);
-        file.write(saveDoc.toJson());
-        file.close();
-    } else {
-        qWarning() << "Impossible d'ouvrir le fichier favorites.json pour l'écriture";
-    }
+    const int id = currentId();
+    if (id == FavoritesModel::RootId || !m_model->contains(id) || m_nameEdit->text().isEmpty())
+        return;
+
+    // Un dossier n'a pas d'URL
+    const QString url = m_model->tree().isFolder(id) ? QString() : m_urlEdit->text();
+    m_model->updateFavorite(id, m_nameEdit->text(), url);
 }
 
-void FavoritesManager::saveFavoritesRecursive(QStandardItem* item, QJsonArray& array)
+void FavoritesManager::importFavorites()
 {
-    for (int i = 0; i < item->rowCount(); ++i) {
-        QStandardItem* child = item->child(i);
-        QJsonObject obj;
-        obj["title"] = child->text();
-
-        bool isFolder = child->data(Qt::UserRole).toString() == "folder";
-        obj["folder"] = isFolder;
-
-        if (!isFolder) {
-            obj["url"] = child->data(Qt::UserRole + 1).toString();
-            obj["favicon"] = child->data(Qt::UserRole + 2).toString();
-        }
-
-        if (child->hasChildren()) {
-            QJsonArray childArray;
-            saveFavoritesRecursive(child, childArray);
-            obj["children"] = childArray;
-        }
-
-        array.append(obj);
-    }
+    const QString filePath = QFileDialog::getOpenFileName(this, tr("Importer des favoris"), QString(),
+                                                          tr("Favoris (*.json)"));
+    if (filePath.isEmpty())
+        return;
+
+    m_model->importFromJson(filePath).then(this, [this](bool ok) {
+        if (!ok)
+            QMessageBox::warning(this, tr("Favoris"), tr("Impossible d'importer ce fichier."));
+    });
 }
 
-
-void FavoritesManager::createDefaultFolder()
+void FavoritesManager::exportFavorites()
 {
-    QStandardItem* defaultFolder = new QStandardItem(tr("Favoris"));
-    defaultFolder->setData("folder", Qt::UserRole);
-    m_favoritesModel->appendRow(defaultFolder);
+    const QString filePath = QFileDialog::getSaveFileName(this, tr("Exporter les favoris"), "favorites.json",
+                                                          tr("Favoris (*.json)"));
+    if (filePath.isEmpty())
+        return;
+
+    m_model->exportToJson(filePath).then(this, [this](bool ok) {
+        if (!ok)
+            QMessageBox::warning(this, tr("Favoris"), tr("Impossible d'exporter les favoris."));
+    });
 }
 
 
 void FavoritesManager::showContextMenu(const QPoint &pos)
 {
-    QModelIndex index = m_favoritesTree->indexAt(pos);
     QMenu contextMenu(this);
 
     QAction *addFolderAction = contextMenu.addAction(tr("Ajouter un dossier"));
@@ -256,45 +368,3 @@ void FavoritesManager::showContextMenu(const QPoint &pos)
 
     contextMenu.exec(m_favoritesTree->viewport()->mapToGlobal(pos));
 }
-
-
-FavoriteItem* FavoritesManager::findFavoriteByUrl(const QUrl& url, FavoriteItem* root) 
-{
-    if(!root) root = m_favoritesRoot;
-    
-    std::function<FavoriteItem*(FavoriteItem*)> search;
-    search = [&](FavoriteItem* node) -> FavoriteItem* {
-        if (node->url == url.toString()) return node;
-        for (FavoriteItem* child : node->children) {
-            if (FavoriteItem* found = search(child)) return found;
-        }
-        return nullptr;
-    };
-
-    return search(root);
-}
-
-void FavoritesManager::updateTreeView(FavoriteItem* root)
-{
-    m_favoritesRoot = root;
-    m_favoritesModel->clear();
-    createDefaultFolder();
-    populateTree(root, m_favoritesModel->invisibleRootItem());
-}
-
-
-void FavoritesManager::populateTree(FavoriteItem* node, QStandardItem* parent)
-{
-    QStandardItem* item = new QStandardItem(node->title);
-    item->setData(QVariant::fromValue(node), Qt::UserRole);
-    
-    if (parent) {
-        parent->appendRow(item);
-    } else {
-        m_favoritesModel->appendRow(item);
-    }
-    
-    for (FavoriteItem* child : node->children) {
-        populateTree(child, item);
-    }
-}
@@ -2,50 +2,58 @@
 #define FAVORITESMANAGER_H
 
 #include <QDialog>
+#include <QHash>
 #include <QTreeView>
 #include <QStandardItemModel>
 #include <QLineEdit>
 #include <QDropEvent>
 #include <QMenu>
-#include "browserwindow.h"
-#include "favoriteitem.h"
 
+class FaviconCache;
+class FavoritesModel;
+
+// Gestionnaire des favoris : une vue de plus sur le FavoritesModel partagé,
+// pas une copie. Chaque action passe par le modèle (donc par la base) et la
+// vue suit ses signaux comme la barre et les menus. Le contenu d'un dossier
+// n'est lu qu'à son dépliage. Le JSON ne sert plus qu'à l'import/export.
 class FavoritesManager : public QDialog
 {
     Q_OBJECT;
 
 public:
-    explicit FavoritesManager(QWidget *parent = nullptr);
+    FavoritesManager(FavoritesModel *model, FaviconCache *icons, QWidget *parent = nullptr);
     void showContextMenu(const QPoint &pos);
-    void updateTreeView(FavoriteItem* root);
 
 protected:
-    void dropEvent(QDropEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private slots:
     void addFolder();
     void addFavorite();
     void deleteFavorite();
     void editFavorite();
-    void saveFavorites();
+    void importFavorites();
+    void exportFavorites();
 
 private:
+    FavoritesModel *m_model;
+    FaviconCache *m_icons;
     QTreeView *m_favoritesTree;
     QStandardItemModel *m_favoritesModel;
-    FavoriteItem* m_favoritesRoot;
     QLineEdit *m_nameEdit;
     QLineEdit *m_urlEdit;
-    QLineEdit *m_tagsEdit;
-
-    void loadFavorites();
-    void loadFavoritesRecursive(const QJsonArray& array, QStandardItem* parent);
-    void saveFavoritesRecursive(QStandardItem* item, QJsonArray& array);
-    void buildFavoriteTree(const QJsonArray& array, FavoriteItem* parent);
-    void serializeFavoriteTree(FavoriteItem* root, QJsonArray& array);
-    FavoriteItem* findFavoriteByUrl(const QUrl& url, FavoriteItem* root = nullptr);
-
-    void createDefaultFolder();
-    void populateTree(FavoriteItem* node, QStandardItem* parent);
+    QHash<int, QStandardItem *> m_items; // id -> élément de la colonne Nom
+
+    void reload();
+    void populate(int folderId);
+    QList<QStandardItem *> createRow(int id);
+    void insertItem(int id);
+    void removeItem(int id);
+    void updateItem(int id);
+    QStandardItem *itemFor(int id) const;
+    int currentId() const;
+    int currentFolder() const;
+    bool handleDrop(QDropEvent *event);
 };
 
 #endif // FAVORITESMANAGER_H
@@ -0,0 +1,276 @@
+#include "favoritesmodel.h"
+
+#include <QDebug>
+
+#include <utility>
+
+namespace {
+
+// Silence attendu avant d'écrire un lot, et délai maximal pendant une rafale
+constexpr int WriteDelayMs = 1000;
+constexpr int MaxWriteDelayMs = 5000;
+
+}
+
+FavoritesModel::FavoritesModel(Database *database, QObject *parent)
+    : QObject(parent)
+    , m_database(database)
+{
+    m_writeTimer.setSingleShot(true);
+    m_writeTimer.setInterval(WriteDelayMs);
+    connect(&m_writeTimer, &QTimer::timeout, this, &FavoritesModel::flush);
+}
+
+FavoritesModel::~FavoritesModel()
+{
+    // Le thread de la base termine sa file avant de s'arrêter
+    flush();
+}
+
+int FavoritesModel::idForUrl(const QUrl &url) const
+{
+    return m_database->favoriteIdForUrl(url);
+}
+
+bool FavoritesModel::isFavorite(const QUrl &url) const
+{
+    return m_database->isFavoriteUrl(url);
+}
+
+void FavoritesModel::load()
+{
+    flush();
+    const int generation = ++m_generation;
+    m_pendingFolders.clear();
+    m_database->getFavoritesAsync(RootId).then(this, [this, generation](const QVector<FavoriteRecord> &records) {
+        if (generation != m_generation)
+            return;
+        m_tree.assign(records);
+        m_loadedFolders = {RootId};
+        emit modelReset();
+    });
+}
+
+void FavoritesModel::fetchChildren(int folderId)
+{
+    if (isLoaded(folderId) || m_pendingFolders.contains(folderId) || !m_tree.isFolder(folderId))
+        return;
+
+    flush();
+    m_pendingFolders.insert(folderId);
+    const int generation = m_generation;
+    m_database->getFavoritesAsync(folderId).then(this, [this, folderId, generation](const QVector<FavoriteRecord> &records) {
+        if (generation != m_generation)
+            return;
+        m_pendingFolders.remove(folderId);
+        if (!m_tree.contains(folderId))
+            return;
+        // Les favoris déjà présents (ajoutés ou déplacés ici entre-temps) sont conservés
+        for (const FavoriteRecord &record : records)
+            m_tree.insert(record);
+        m_loadedFolders.insert(folderId);
+        emit childrenLoaded(folderId);
+    });
+}
+
+QFuture<bool> FavoritesModel::fetchFavorite(int id)
+{
+    if (m_tree.contains(id))
+        return QtFuture::makeReadyValueFuture(true);
+
+    flush();
+    const int generation = m_generation;
+    return m_database->getAncestryAsync(id).then(this, [this, id, generation](const QVector<FavoriteRecord> &chain) {
+        if (generation != m_generation)
+            return false;
+        // De la racine vers le favori : chaque parent est inséré avant son enfant
+        for (const FavoriteRecord &record : chain) {
+            if (!m_tree.contains(record.parentId))
+                break;
+            m_tree.insert(record);
+        }
+        return m_tree.contains(id);
+    });
+}
+
+QFuture<QVector<FavoriteRecord>> FavoritesModel::favoriteLinks()
+{
+    flush();
+    return m_database->getFavoriteLinksAsync();
+}
+
+QFuture<bool> FavoritesModel::importFromJson(const QString &filePath)
+{
+    flush();
+    return m_database->importJsonAsync(filePath).then(this, [this](bool ok) {
+        if (ok)
+            load();
+        return ok;
+    });
+}
+
+QFuture<bool> FavoritesModel::exportToJson(const QString &filePath)
+{
+    flush();
+    return m_database->exportJsonAsync(filePath);
+}
+
+QFuture<int> FavoritesModel::addFavorite(const QString &title, const QString &url, const QString &iconPath, int parentId)
+{
+    flush();
+    return m_database->addFavoriteAsync(title, url, iconPath, parentId).then(this, [=](int id) {
+        if (id == -1) {
+            qWarning() << "Impossible d'ajouter le favori" << title;
+            return id;
+        }
+        // Dossier absent de l'arbre ou pas encore lu : le favori arrivera avec
+        // ses frères, à sa place, quand fetchChildren lira le dossier. Les
+        // vues montrent déjà un dossier non lu comme ayant des enfants.
+        if (!isLoaded(parentId))
+            return id;
+        FavoriteRecord record;
+        record.id = id;
+        record.title = title;
+        record.url = url;
+        record.iconPath = iconPath;
+        record.parentId = parentId;
+        if (!m_tree.insert(record))
+            return id;
+        // Un nouveau dossier est vide : rien à lire à sa première ouverture
+        if (record.isFolder())
+            m_loadedFolders.insert(id);
+        emit itemInserted(id);
+        return id;
+    });
+}
+
+void FavoritesModel::addFolder(const QString &title, int parentId)
+{
+    // Une URL vide, pas nulle : la colonne url est NOT NULL
+    addFavorite(title, QStringLiteral(""), QString(), parentId);
+}
+
+QFuture<bool> FavoritesModel::removeFavorite(int id)
+{
+    if (id == RootId)
+        return QtFuture::makeReadyValueFuture(false);
+
+    // Le sous-arbre est supprimé en base par une seule requête récursive,
+    // y compris les dossiers jamais chargés
+    flush();
+    return m_database->deleteFavoriteTreeAsync(id).then(this, [this, id](const QList<int> &removed) {
+        if (removed.isEmpty())
+            return false;
+        for (int removedId : removed) {
+            m_loadedFolders.remove(removedId);
+            m_pendingFolders.remove(removedId);
+        }
+        const int parentId = m_tree.contains(id) ? m_tree.parentId(id) : -1;
+        m_tree.remove(id);
+        emit itemRemoved(id, parentId);
+        return true;
+    });
+}
+
+void FavoritesModel::updateFavorite(int id, const QString &title, const QString &url)
+{
+    if (id == RootId || !m_tree.contains(id))
+        return;
+
+    flush();
+    m_database->updateFavoriteAsync(id, title, url).then(this, [=](bool ok) {
+        if (!ok || !m_tree.contains(id))
+            return;
+        m_tree.setTitle(id, title);
+        m_tree.setUrl(id, url);
+        emit itemChanged(id);
+    });
+}
+
+void FavoritesModel::moveFavorite(int id, int newParentId, int row)
+{
+    if (id == RootId || !m_tree.contains(id) || !m_tree.isFolder(newParentId)
+        || m_tree.isAncestorOf(id, newParentId))
+        return;
+
+    // Voisins à la place visée, le favori déplacé mis à part : la base
+    // calcule une clé d'ordre entre les leurs et n'écrit que cette ligne
+    QList<int> siblings = m_tree.children(newParentId);
+    siblings.removeOne(id);
+    if (row < 0 || row > siblings.size())
+        row = siblings.size();
+    int prevId = row > 0 ? siblings.at(row - 1) : -1;
+    int nextId = row < siblings.size() ? siblings.at(row) : -1;
+    if (!isLoaded(newParentId))
+        prevId = nextId = -1; // contenu inconnu : en fin de dossier
+
+    const int oldParentId = m_tree.parentId(id);
+    if (!m_tree.move(id, newParentId, row))
+        return;
+
+    FavoriteWrite write;
+    write.kind = FavoriteWrite::Move;
+    write.id = id;
+    write.parentId = newParentId;
+    write.prevId = prevId;
+    write.nextId = nextId;
+    queueWrite(write);
+    emit itemMoved(id, oldParentId);
+}
+
+void FavoritesModel::setFavoriteIcon(int id, const QString &iconPath)
+{
+    // Un favori pas encore chargé reçoit quand même son icône en base
+    if (id == RootId || (m_tree.contains(id) && m_tree.iconPath(id) == iconPath))
+        return;
+
+    FavoriteWrite write;
+    write.kind = FavoriteWrite::Icon;
+    write.id = id;
+    write.iconPath = iconPath;
+    queueWrite(write);
+
+    if (m_tree.contains(id)) {
+        m_tree.setIconPath(id, iconPath);
+        emit itemChanged(id);
+    }
+}
+
+void FavoritesModel::queueWrite(const FavoriteWrite &write)
+{
+    // Seule la dernière icône d'un favori compte ; les déplacements, eux,
+    // dépendent les uns des autres et gardent leur ordre
+    if (write.kind == FavoriteWrite::Icon) {
+        for (FavoriteWrite &pending : m_writes) {
+            if (pending.kind == FavoriteWrite::Icon && pending.id == write.id) {
+                pending.iconPath = write.iconPath;
+                return;
+            }
+        }
+    }
+
+    if (m_writes.isEmpty())
+        m_firstWrite.start();
+    m_writes.append(write);
+    if (m_firstWrite.elapsed() >= MaxWriteDelayMs)
+        flush();
+    else
+        m_writeTimer.start();
+}
+
+void FavoritesModel::flush()
+{
+    m_writeTimer.stop();
+    if (m_writes.isEmpty())
+        return;
+
+    const QList<FavoriteWrite> writes = std::exchange(m_writes, {});
+    const int generation = m_generation;
+    m_database->applyWritesAsync(writes).then(this, [this, generation](bool ok) {
+        // Lot annulé en entier : l'arbre repart de ce que contient la base
+        if (!ok && generation == m_generation) {
+            qWarning() << "Échec de l'enregistrement des favoris, rechargement";
+            load();
+        }
+    });
+}
@@ -0,0 +1,89 @@
+#ifndef FAVORITESMODEL_H
+#define FAVORITESMODEL_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QSet>
+#include <QTimer>
+#include <QUrl>
+
+#include "database.h"
+#include "favoritestree.h"
+
+// Arbre des favoris en mémoire. Chaque modification est écrite en base puis
+// appliquée comme un correctif local, suivi d'un signal fin : les vues
+// n'ont jamais à tout recharger pour un ajout, une suppression ou un renommage.
+// Les vues lisent l'arbre par identifiant via tree().
+//
+// Le chargement est paresseux : load() ne lit que la racine, et le contenu
+// d'un dossier n'est demandé qu'à sa première ouverture (fetchChildren).
+//
+// Déplacements et icônes, qui arrivent en rafales (glisser-déposer, favicons),
+// sont appliqués tout de suite à l'arbre puis écrits en différé : le lot part
+// quand plus rien n'arrive pendant un moment, en une seule transaction. Toute
+// autre requête à la base vide d'abord ce lot pour garder l'ordre.
+class FavoritesModel : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FavoritesModel(Database *database, QObject *parent = nullptr);
+    ~FavoritesModel();
+
+    static constexpr int RootId = FavoritesTree::RootId;
+
+    const FavoritesTree &tree() const { return m_tree; }
+    bool contains(int id) const { return m_tree.contains(id); }
+    bool isLoaded(int folderId) const { return m_loadedFolders.contains(folderId); }
+    // Id en base, que le favori soit chargé dans l'arbre ou non
+    int idForUrl(const QUrl &url) const;
+    bool isFavorite(const QUrl &url) const;
+
+    void load();
+    void fetchChildren(int folderId);
+    // Charge un favori et ses dossiers parents ; vrai s'il est dans l'arbre
+    QFuture<bool> fetchFavorite(int id);
+    // Tous les favoris qui ont une adresse, chargés dans l'arbre ou non
+    QFuture<QVector<FavoriteRecord>> favoriteLinks();
+
+    // Échange au format favorites.json ; un import recharge l'arbre
+    QFuture<bool> importFromJson(const QString &filePath);
+    QFuture<bool> exportToJson(const QString &filePath);
+
+    // Les futurs se terminent une fois l'arbre mis à jour : id ajouté (-1 en
+    // cas d'échec), vrai si le favori a été supprimé
+    QFuture<int> addFavorite(const QString &title, const QString &url, const QString &iconPath = QString(),
+                             int parentId = RootId);
+    void addFolder(const QString &title, int parentId = RootId);
+    QFuture<bool> removeFavorite(int id);
+    void updateFavorite(int id, const QString &title, const QString &url);
+    // row : rang parmi les autres enfants de newParentId, -1 pour la fin
+    void moveFavorite(int id, int newParentId, int row = -1);
+    void setFavoriteIcon(int id, const QString &iconPath);
+    // Envoie tout de suite les écritures différées
+    void flush();
+
+signals:
+    void modelReset();
+    void childrenLoaded(int folderId);
+    void itemInserted(int id);
+    // parentId vaut -1 si le favori supprimé n'était pas chargé
+    void itemRemoved(int id, int parentId);
+    void itemMoved(int id, int oldParentId);
+    void itemChanged(int id);
+
+private:
+    void queueWrite(const FavoriteWrite &write);
+
+    Database *m_database;
+    FavoritesTree m_tree;
+    QSet<int> m_loadedFolders;
+    QSet<int> m_pendingFolders;
+    int m_generation = 0; // invalide les réponses arrivées après un load()
+    QList<FavoriteWrite> m_writes;
+    QTimer m_writeTimer;
+    QElapsedTimer m_firstWrite; // une rafale continue ne retarde pas l'écriture indéfiniment
+};
+
+#endif // FAVORITESMODEL_H
@@ -0,0 +1,290 @@
+#include "favoritestree.h"
+
+FavoritesTree::FavoritesTree()
+{
+    clear();
+}
+
+void FavoritesTree::clear()
+{
+    m_nodes.clear();
+    m_nodes.append(FavoriteItem{RootId});
+    m_freeNodes.clear();
+    m_indexById.clear();
+    m_strings.clear();
+    m_strings.append(QString());
+    m_stringIds.clear();
+    m_stringIds.insert(QString(), 0);
+}
+
+void FavoritesTree::assign(const QVector<FavoriteRecord> &records)
+{
+    clear();
+    m_nodes.reserve(records.size() + 1);
+    m_indexById.reserve(records.size());
+
+    // Deux passes : un parent peut apparaître après ses enfants
+    for (const FavoriteRecord &record : records) {
+        if (record.id != RootId && !m_indexById.contains(record.id))
+            allocate(record);
+    }
+    for (const FavoriteRecord &record : records) {
+        const int index = indexOf(record.id);
+        if (index <= 0 || m_nodes[index].parent != -1)
+            continue;
+        // Un parent inconnu ou un cycle rattache le nœud à la racine
+        int parent = indexOf(record.parentId);
+        if (parent == -1 || isAncestorOf(record.id, record.parentId))
+            parent = 0;
+        link(index, parent, -1);
+    }
+}
+
+int FavoritesTree::allocate(const FavoriteRecord &record)
+{
+    FavoriteItem node;
+    node.id = record.id;
+    node.title = intern(record.title);
+    node.url = intern(record.url);
+    node.iconPath = intern(record.iconPath);
+
+    int index;
+    if (!m_freeNodes.isEmpty()) {
+        index = m_freeNodes.takeLast();
+        m_nodes[index] = node;
+    } else {
+        index = m_nodes.size();
+        m_nodes.append(node);
+    }
+    m_indexById.insert(record.id, index);
+    return index;
+}
+
+int FavoritesTree::intern(const QString &value)
+{
+    if (value.isEmpty())
+        return 0;
+    auto it = m_stringIds.constFind(value);
+    if (it != m_stringIds.constEnd())
+        return it.value();
+    const int ref = m_strings.size();
+    m_strings.append(value);
+    m_stringIds.insert(value, ref);
+    return ref;
+}
+
+void FavoritesTree::link(int index, int parent, int row)
+{
+    FavoriteItem &p = m_nodes[parent];
+
+    int next = -1;
+    if (row >= 0 && row < p.childCount) {
+        next = p.firstChild;
+        for (int i = 0; i < row; ++i)
+            next = m_nodes[next].nextSibling;
+    }
+
+    FavoriteItem &node = m_nodes[index];
+    node.parent = parent;
+    node.nextSibling = next;
+    node.prevSibling = next == -1 ? p.lastChild : m_nodes[next].prevSibling;
+
+    if (node.prevSibling == -1)
+        p.firstChild = index;
+    else
+        m_nodes[node.prevSibling].nextSibling = index;
+    if (next == -1)
+        p.lastChild = index;
+    else
+        m_nodes[next].prevSibling = index;
+    ++p.childCount;
+}
+
+void FavoritesTree::unlink(int index)
+{
+    FavoriteItem &node = m_nodes[index];
+    if (node.parent == -1)
+        return;
+    FavoriteItem &p = m_nodes[node.parent];
+
+    if (node.prevSibling == -1)
+        p.firstChild = node.nextSibling;
+    else
+        m_nodes[node.prevSibling].nextSibling = node.nextSibling;
+    if (node.nextSibling == -1)
+        p.lastChild = node.prevSibling;
+    else
+        m_nodes[node.nextSibling].prevSibling = node.prevSibling;
+    --p.childCount;
+
+    node.parent = node.prevSibling = node.nextSibling = -1;
+}
+
+bool FavoritesTree::insert(const FavoriteRecord &record, int row)
+{
+    if (record.id == RootId || m_indexById.contains(record.id))
+        return false;
+    int parent = indexOf(record.parentId);
+    if (parent == -1)
+        parent = 0;
+    link(allocate(record), parent, row);
+    return true;
+}
+
+QList<int> FavoritesTree::remove(int id)
+{
+    const int index = indexOf(id);
+    if (index <= 0)
+        return {};
+
+    QList<int> removed = subtree(id);
+    unlink(index);
+    for (int removedId : std::as_const(removed)) {
+        const int i = m_indexById.take(removedId);
+        m_nodes[i] = FavoriteItem();
+        m_freeNodes.append(i);
+    }
+    return removed;
+}
+
+bool FavoritesTree::move(int id, int newParentId, int row)
+{
+    const int index = indexOf(id);
+    const int parent = indexOf(newParentId);
+    if (index <= 0 || parent == -1 || isAncestorOf(id, newParentId))
+        return false;
+    unlink(index);
+    link(index, parent, row);
+    return true;
+}
+
+void FavoritesTree::setTitle(int id, const QString &title)
+{
+    const int index = indexOf(id);
+    if (index > 0)
+        m_nodes[index].title = intern(title);
+}
+
+void FavoritesTree::setUrl(int id, const QString &url)
+{
+    const int index = indexOf(id);
+    if (index > 0)
+        m_nodes[index].url = intern(url);
+}
+
+void FavoritesTree::setIconPath(int id, const QString &iconPath)
+{
+    const int index = indexOf(id);
+    if (index > 0)
+        m_nodes[index].iconPath = intern(iconPath);
+}
+
+QString FavoritesTree::title(int id) const
+{
+    const int index = indexOf(id);
+    return index > 0 ? m_strings[m_nodes[index].title] : QString();
+}
+
+QString FavoritesTree::url(int id) const
+{
+    const int index = indexOf(id);
+    return index > 0 ? m_strings[m_nodes[index].url] : QString();
+}
+
+QString FavoritesTree::iconPath(int id) const
+{
+    const int index = indexOf(id);
+    return index > 0 ? m_strings[m_nodes[index].iconPath] : QString();
+}
+
+bool FavoritesTree::isFolder(int id) const
+{
+    const int index = indexOf(id);
+    return index != -1 && m_nodes[index].isFolder();
+}
+
+int FavoritesTree::parentId(int id) const
+{
+    const int index = indexOf(id);
+    if (index <= 0 || m_nodes[index].parent == -1)
+        return RootId;
+    return m_nodes[m_nodes[index].parent].id;
+}
+
+int FavoritesTree::childCount(int id) const
+{
+    const int index = indexOf(id);
+    return index == -1 ? 0 : m_nodes[index].childCount;
+}
+
+int FavoritesTree::childAt(int parentId, int row) const
+{
+    const int parent = indexOf(parentId);
+    if (parent == -1 || row < 0 || row >= m_nodes[parent].childCount)
+        return -1;
+    int i = m_nodes[parent].firstChild;
+    while (row-- > 0)
+        i = m_nodes[i].nextSibling;
+    return m_nodes[i].id;
+}
+
+int FavoritesTree::rowOf(int id) const
+{
+    int row = 0;
+    for (int i = indexOf(id); i > 0 && m_nodes[i].prevSibling != -1; i = m_nodes[i].prevSibling)
+        ++row;
+    return row;
+}
+
+int FavoritesTree::nextSibling(int id) const
+{
+    const int index = indexOf(id);
+    if (index <= 0 || m_nodes[index].nextSibling == -1)
+        return -1;
+    return m_nodes[m_nodes[index].nextSibling].id;
+}
+
+QList<int> FavoritesTree::children(int id) const
+{
+    QList<int> ids;
+    ids.reserve(childCount(id));
+    forEachChild(id, [&ids](int childId) { ids.append(childId); });
+    return ids;
+}
+
+QList<int> FavoritesTree::subtree(int id) const
+{
+    // Ordre postfixe, sans récursion : les descendants avant leur dossier
+    const int top = indexOf(id);
+    if (top <= 0)
+        return {};
+
+    QList<int> ids;
+    int i = top;
+    for (;;) {
+        while (m_nodes[i].firstChild != -1)
+            i = m_nodes[i].firstChild;
+        for (;;) {
+            ids.append(m_nodes[i].id);
+            if (i == top)
+                return ids;
+            if (m_nodes[i].nextSibling != -1) {
+                i = m_nodes[i].nextSibling;
+                break;
+            }
+            i = m_nodes[i].parent;
+        }
+    }
+}
+
+bool FavoritesTree::isAncestorOf(int ancestorId, int id) const
+{
+    const int ancestor = indexOf(ancestorId);
+    if (ancestor == -1)
+        return false;
+    for (int i = indexOf(id); i != -1; i = m_nodes[i].parent) {
+        if (i == ancestor)
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,87 @@
+#ifndef FAVORITESTREE_H
+#define FAVORITESTREE_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "favoriteitem.h"
+#include "favoriterecord.h"
+
+// Arbre des favoris stocké dans un tableau contigu de nœuds. Les parcours
+// suivent des indices au lieu de pointeurs, les titres, URL et chemins
+// d'icônes identiques ne sont stockés qu'une fois, et vider l'arbre ne
+// demande aucune libération nœud par nœud. L'API publique ne manipule que
+// les identifiants de la base ; les indices restent internes.
+class FavoritesTree
+{
+public:
+    // Dans la base, parent_id = 0 désigne la racine
+    static constexpr int RootId = 0;
+
+    FavoritesTree();
+
+    void clear();
+    void assign(const QVector<FavoriteRecord> &records);
+    int size() const { return m_indexById.size(); }
+
+    bool contains(int id) const { return id == RootId || m_indexById.contains(id); }
+    bool insert(const FavoriteRecord &record, int row = -1);
+    QList<int> remove(int id);
+    bool move(int id, int newParentId, int row = -1);
+    void setTitle(int id, const QString &title);
+    void setUrl(int id, const QString &url);
+    void setIconPath(int id, const QString &iconPath);
+
+    QString title(int id) const;
+    QString url(int id) const;
+    QString iconPath(int id) const;
+    bool isFolder(int id) const;
+    int parentId(int id) const;
+    int childCount(int id) const;
+    int childAt(int parentId, int row) const;
+    int rowOf(int id) const;
+    int nextSibling(int id) const;
+    QList<int> children(int id) const;
+    QList<int> subtree(int id) const;
+    bool isAncestorOf(int ancestorId, int id) const;
+
+    // Enfants directs, dans l'ordre
+    template <typename Fn>
+    void forEachChild(int parentId, Fn fn) const
+    {
+        const int parent = indexOf(parentId);
+        for (int i = parent == -1 ? -1 : m_nodes[parent].firstChild; i != -1; i = m_nodes[i].nextSibling)
+            fn(m_nodes[i].id);
+    }
+
+    // Tous les favoris (hors dossiers) par un balayage linéaire du tableau
+    template <typename Fn>
+    void forEachFavorite(Fn fn) const
+    {
+        for (qsizetype i = 1; i < m_nodes.size(); ++i) {
+            const FavoriteItem &node = m_nodes[i];
+            if (node.id != -1 && !node.isFolder())
+                fn(node.id, m_strings[node.url]);
+        }
+    }
+
+private:
+    int indexOf(int id) const { return id == RootId ? 0 : m_indexById.value(id, -1); }
+    int allocate(const FavoriteRecord &record);
+    void link(int index, int parent, int row);
+    void unlink(int index);
+    int intern(const QString &value);
+
+    QVector<FavoriteItem> m_nodes;  // m_nodes[0] est la racine
+    QVector<int> m_freeNodes;
+    QHash<int, int> m_indexById;
+
+    // Pool de chaînes : m_strings[0] est la chaîne vide. Il ne fait que
+    // grandir et n'est compacté qu'au prochain clear().
+    QVector<QString> m_strings;
+    QHash<QString, int> m_stringIds;
+};
+
+#endif // FAVORITESTREE_H
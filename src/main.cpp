@@ -1,6 +1,7 @@
 #include "browser.h"
 #include "browserwindow.h"
 #include "tabwidget.h"
+#include "webview.h"
 #include <QApplication>
 #include <QLoggingCategory>
 #include <QWebEngineProfile>
@@ -18,7 +19,7 @@ QUrl commandLineUrlArgument()
         if (!arg.startsWith(u'-'))
             return QUrl::fromUserInput(arg);
     }
-    return QUrl(u"chrome://qt"_s);
+    return QUrl();
 }
 
 int main(int argc, char **argv)
@@ -38,18 +39,15 @@ int main(int argc, char **argv)
 
     QUrl url = commandLineUrlArgument();
 
-    QDir().mkpath(QDir::currentPath() + "/src/favorites");
-    QFile file(QDir::currentPath() + "/src/favorites/favorites.json");
-    if (!file.exists()) {
-        if (file.open(QIODevice::WriteOnly)) {
-            file.write("[]");
-            file.close();
-        }
-    }
-
     Browser browser;
-    BrowserWindow *window = browser.createHiddenWindow();
-    window->tabWidget()->setUrl(url);
-    window->show();
+    if (browser.restoreSession()) {
+        // L'adresse passée en argument s'ajoute aux onglets restaurés
+        if (!url.isEmpty())
+            browser.windows().constLast()->tabWidget()->createTab()->setUrl(url);
+    } else {
+        BrowserWindow *window = browser.createHiddenWindow();
+        window->tabWidget()->setUrl(url.isEmpty() ? QUrl(u"chrome://qt"_s) : url);
+        window->show();
+    }
     return app.exec();
 }
@@ -0,0 +1,184 @@
+#include "omniboxengine.h"
+#include "favoritesmodel.h"
+#include "historystore.h"
+#include "omniboxindex.h"
+
+#include <QDateTime>
+#include <QUrl>
+
+namespace {
+
+// Les scores dépendent de l'ancienneté des visites : recalculés toutes les heures
+constexpr int RescoreIntervalMs = 60 * 60 * 1000;
+// Les modifications de favoris arrivent souvent par rafales (import, déplacements)
+constexpr int FavoritesSyncDelayMs = 500;
+
+}
+
+struct OmniboxEngine::State
+{
+    HistoryStore history;
+    OmniboxIndex index;
+
+    QList<OmniboxSuggestion> suggestions(const QList<int> &ids) const
+    {
+        QList<OmniboxSuggestion> result;
+        result.reserve(ids.size());
+        for (int id : ids) {
+            const OmniboxIndex::Entry &entry = index.entry(id);
+            result.append({entry.url, entry.title.isEmpty() ? entry.favoriteTitle : entry.title, entry.favorite});
+        }
+        return result;
+    }
+};
+
+OmniboxEngine::OmniboxEngine(FavoritesModel *favorites, QObject *parent)
+    : QObject(parent)
+    , m_favorites(favorites)
+    , m_worker(new QObject)
+    , m_state(new State)
+{
+    m_thread.setObjectName("Omnibox");
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_thread.start(QThread::LowPriority);
+
+    // La connexion SQLite appartient au thread qui l'ouvre
+    QMetaObject::invokeMethod(m_worker, [state = m_state]() {
+        if (!state->history.open())
+            return;
+        state->history.forEach([state](const HistoryStore::Row &row) {
+            state->index.setEntry(row.url, row.title, row.visitCount, row.lastVisit);
+        });
+    }, Qt::QueuedConnection);
+
+    m_favoritesTimer.setSingleShot(true);
+    m_favoritesTimer.setInterval(FavoritesSyncDelayMs);
+    connect(&m_favoritesTimer, &QTimer::timeout, this, &OmniboxEngine::syncFavorites);
+    // Relecture complète au chargement et après un import ; sinon seul le
+    // favori touché est envoyé
+    connect(m_favorites, &FavoritesModel::modelReset, this, [this]() { m_favoritesTimer.start(); });
+    connect(m_favorites, &FavoritesModel::itemInserted, this, &OmniboxEngine::updateFavorite);
+    connect(m_favorites, &FavoritesModel::itemChanged, this, &OmniboxEngine::updateFavorite);
+    connect(m_favorites, &FavoritesModel::itemRemoved, this, &OmniboxEngine::removeFavorite);
+    syncFavorites();
+
+    m_rescoreTimer.setInterval(RescoreIntervalMs);
+    connect(&m_rescoreTimer, &QTimer::timeout, this, [this]() {
+        QMetaObject::invokeMethod(m_worker, [state = m_state, now = QDateTime::currentSecsSinceEpoch()]() {
+            state->index.rescore(now);
+        }, Qt::QueuedConnection);
+    });
+    m_rescoreTimer.start();
+}
+
+OmniboxEngine::~OmniboxEngine()
+{
+    // Les requêtes en cours deviennent caduques ; les visites en file sont
+    // écrites, puis l'historique est fermé depuis son propre thread
+    m_generation.fetchAndAddRelaxed(1);
+    QMetaObject::invokeMethod(m_worker, [state = m_state]() {
+        delete state;
+    }, Qt::BlockingQueuedConnection);
+    m_thread.quit();
+    m_thread.wait();
+}
+
+int OmniboxEngine::complete(const QString &text)
+{
+    const int query = m_generation.fetchAndAddRelaxed(1) + 1;
+    const QString trimmed = text.trimmed();
+    if (trimmed.isEmpty())
+        return query;
+
+    QMetaObject::invokeMethod(m_worker, [this, state = m_state, query, trimmed]() {
+        // Une frappe plus récente est déjà en file : inutile de chercher
+        if (m_generation.loadRelaxed() != query)
+            return;
+
+        const QList<int> prefix = state->index.prefixMatches(trimmed, MaxSuggestions);
+        const QList<OmniboxSuggestion> first = state->suggestions(prefix);
+        QMetaObject::invokeMethod(this, [this, query, first]() {
+            emit suggestionsReady(query, first, false);
+        }, Qt::QueuedConnection);
+
+        const QList<int> words = state->index.tokenMatches(trimmed, MaxSuggestions, [this, query]() {
+            return m_generation.loadRelaxed() != query;
+        });
+        if (m_generation.loadRelaxed() != query)
+            return;
+
+        // Les adresses commençant par le texte tapé restent en tête
+        QList<int> ids = prefix;
+        for (int id : words) {
+            if (ids.size() >= MaxSuggestions)
+                break;
+            if (!ids.contains(id))
+                ids.append(id);
+        }
+        const QList<OmniboxSuggestion> merged = state->suggestions(ids);
+        QMetaObject::invokeMethod(this, [this, query, merged]() {
+            emit suggestionsReady(query, merged, true);
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+    return query;
+}
+
+void OmniboxEngine::recordVisit(const QUrl &url, const QString &title)
+{
+    const QString scheme = url.scheme();
+    if (scheme != QLatin1String("http") && scheme != QLatin1String("https"))
+        return;
+
+    QMetaObject::invokeMethod(m_worker, [state = m_state, url = url.toString(), title,
+                                         now = QDateTime::currentSecsSinceEpoch()]() {
+        HistoryStore::Row row;
+        row.url = url;
+        row.title = title;
+        row.lastVisit = now;
+        const int id = state->index.find(url);
+        if (id != -1) {
+            const OmniboxIndex::Entry &entry = state->index.entry(id);
+            row.visitCount = entry.visitCount;
+            if (row.title.isEmpty())
+                row.title = entry.title;
+        }
+        ++row.visitCount;
+        row.key = OmniboxIndex::urlKey(url);
+        state->index.setEntry(row.url, row.title, row.visitCount, row.lastVisit);
+        state->history.recordVisit(row);
+    }, Qt::QueuedConnection);
+}
+
+void OmniboxEngine::syncFavorites()
+{
+    m_favorites->favoriteLinks().then(this, [this](const QVector<FavoriteRecord> &records) {
+        QHash<int, OmniboxIndex::Favorite> favorites;
+        favorites.reserve(records.size());
+        for (const FavoriteRecord &record : records)
+            favorites.insert(record.id, {record.url, record.title});
+        QMetaObject::invokeMethod(m_worker, [state = m_state, favorites]() {
+            state->index.setFavorites(favorites);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void OmniboxEngine::updateFavorite(int id)
+{
+    const FavoritesTree &tree = m_favorites->tree();
+    if (!tree.contains(id) || tree.isFolder(id))
+        return;
+    QMetaObject::invokeMethod(m_worker, [state = m_state, id, url = tree.url(id), title = tree.title(id)]() {
+        state->index.setFavorite(id, url, title);
+    }, Qt::QueuedConnection);
+}
+
+void OmniboxEngine::removeFavorite(int id)
+{
+    QMetaObject::invokeMethod(m_worker, [this, state = m_state, id]() {
+        // Un dossier emporte des favoris dont seul l'index connaît les ids :
+        // tout est relu
+        if (!state->index.removeFavorite(id))
+            QMetaObject::invokeMethod(this, [this]() { m_favoritesTimer.start(); }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
@@ -0,0 +1,60 @@
+#ifndef OMNIBOXENGINE_H
+#define OMNIBOXENGINE_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include <QUrl>
+
+class FavoritesModel;
+
+struct OmniboxSuggestion
+{
+    QString url;
+    QString title;
+    bool favorite = false;
+};
+
+// Suggestions de la barre d'adresse. L'historique et l'index vivent sur un
+// thread dédié : chargement, filtrage et classement ne touchent jamais le
+// thread de l'interface.
+//
+// complete() renvoie un numéro de requête ; suggestionsReady arrive deux fois
+// pour ce numéro : d'abord les adresses commençant par le texte tapé
+// (immédiat), puis la liste complétée par les titres et mots (final). Une
+// requête remplacée par une plus récente est abandonnée sans résultat.
+class OmniboxEngine : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr int MaxSuggestions = 10;
+
+    explicit OmniboxEngine(FavoritesModel *favorites, QObject *parent = nullptr);
+    ~OmniboxEngine();
+
+    int complete(const QString &text);
+    void recordVisit(const QUrl &url, const QString &title);
+
+signals:
+    void suggestionsReady(int query, const QList<OmniboxSuggestion> &suggestions, bool final);
+
+private:
+    struct State;
+
+    void syncFavorites();
+    void updateFavorite(int id);
+    void removeFavorite(int id);
+
+    FavoritesModel *m_favorites;
+    QThread m_thread;
+    QObject *m_worker; // contexte des tâches, vit sur m_thread
+    State *m_state;    // n'est touché que depuis m_thread
+    QAtomicInt m_generation;
+    QTimer m_favoritesTimer;
+    QTimer m_rescoreTimer;
+};
+
+#endif // OMNIBOXENGINE_H
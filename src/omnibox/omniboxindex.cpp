@@ -0,0 +1,397 @@
+#include "omniboxindex.h"
+
+#include <QDateTime>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Au-delà, la recherche par mots s'arrête sur les candidats déjà vus (les
+// plus récemment ajoutés d'abord) ; la recherche par préfixe reste exacte
+constexpr int MaxTokenCandidates = 50000;
+constexpr int CancelCheckInterval = 1024;
+constexpr float FavoriteBonus = 100;
+
+QStringList tokenize(const QString &text)
+{
+    QStringList tokens;
+    qsizetype start = -1;
+    for (qsizetype i = 0; i <= text.size(); ++i) {
+        const bool word = i < text.size() && text.at(i).isLetterOrNumber();
+        if (word && start == -1) {
+            start = i;
+        } else if (!word && start != -1) {
+            tokens.append(text.mid(start, i - start));
+            start = -1;
+        }
+    }
+    return tokens;
+}
+
+// Un mot de text commence par word
+bool hasWordStartingWith(const QString &text, const QString &word)
+{
+    for (qsizetype i = text.indexOf(word); i != -1; i = text.indexOf(word, i + 1)) {
+        if (i == 0 || !text.at(i - 1).isLetterOrNumber())
+            return true;
+    }
+    return false;
+}
+
+}
+
+OmniboxIndex::OmniboxIndex()
+    : m_nodes(1)
+    , m_now(QDateTime::currentSecsSinceEpoch())
+{
+}
+
+QString OmniboxIndex::urlKey(const QString &url)
+{
+    QString key = url.trimmed().toLower();
+    if (key.startsWith(QLatin1String("https://")))
+        key.remove(0, 8);
+    else if (key.startsWith(QLatin1String("http://")))
+        key.remove(0, 7);
+    if (key.startsWith(QLatin1String("www.")))
+        key.remove(0, 4);
+    if (key.endsWith(QLatin1Char('/')) && key.indexOf(QLatin1Char('/')) == key.size() - 1)
+        key.chop(1);
+    return key;
+}
+
+int OmniboxIndex::setEntry(const QString &url, const QString &title, int visitCount, qint64 lastVisit)
+{
+    const QString key = urlKey(url);
+    if (key.isEmpty())
+        return -1;
+
+    int id = m_idByKey.value(key, -1);
+    if (id == -1) {
+        id = m_entries.size();
+        Entry entry;
+        entry.text = key;
+        m_entries.append(entry);
+        m_idByKey.insert(key, id);
+        indexTokens(id, key);
+        m_entries[id].node = insertKey(key, id);
+    }
+
+    Entry &entry = m_entries[id];
+    if (!url.isEmpty())
+        entry.url = url;
+    if (!title.isEmpty() && title != entry.title) {
+        entry.title = title;
+        updateText(id);
+    }
+    entry.visitCount = visitCount;
+    entry.lastVisit = lastVisit;
+    entry.score = frecency(entry, m_now);
+    refreshPath(entry.node);
+    return id;
+}
+
+void OmniboxIndex::setFavorites(const QHash<int, Favorite> &favorites)
+{
+    const QList<int> known = m_entryByFavorite.keys();
+    for (int favoriteId : known) {
+        if (!favorites.contains(favoriteId))
+            removeFavorite(favoriteId);
+    }
+    for (auto it = favorites.cbegin(); it != favorites.cend(); ++it)
+        setFavorite(it.key(), it->url, it->title);
+}
+
+void OmniboxIndex::setFavorite(int favoriteId, const QString &url, const QString &title)
+{
+    int id = find(url);
+    if (id == -1)
+        id = setEntry(url, QString(), 0, 0);
+
+    // Adresse modifiée : l'ancienne entrée perd ce favori
+    const int previous = m_entryByFavorite.value(favoriteId, -1);
+    if (previous != -1 && previous != id) {
+        m_entryByFavorite.remove(favoriteId);
+        releaseFavorite(previous);
+    }
+    if (id == -1)
+        return; // adresse vide : rien à proposer
+    if (previous != id) {
+        m_entryByFavorite.insert(favoriteId, id);
+        ++m_favoriteCounts[id];
+    }
+
+    Entry &entry = m_entries[id];
+    if (!title.isEmpty() && title != entry.favoriteTitle) {
+        entry.favoriteTitle = title;
+        updateText(id);
+    }
+    refreshFavorite(id);
+}
+
+bool OmniboxIndex::removeFavorite(int favoriteId)
+{
+    auto it = m_entryByFavorite.constFind(favoriteId);
+    if (it == m_entryByFavorite.cend())
+        return false;
+    const int id = it.value();
+    m_entryByFavorite.erase(it);
+    releaseFavorite(id);
+    return true;
+}
+
+void OmniboxIndex::rescore(qint64 now)
+{
+    m_now = now;
+    for (Entry &entry : m_entries)
+        entry.score = frecency(entry, now);
+
+    // Parcours préfixe puis traitement à rebours : les enfants avant leur parent
+    QVector<int> order;
+    order.reserve(m_nodes.size());
+    QVector<int> pending = {0};
+    while (!pending.isEmpty()) {
+        const int node = pending.takeLast();
+        order.append(node);
+        pending.append(m_nodes.at(node).children);
+    }
+    for (auto it = order.crbegin(); it != order.crend(); ++it)
+        refresh(*it);
+}
+
+QList<int> OmniboxIndex::prefixMatches(const QString &text, int count) const
+{
+    const QString key = urlKey(text);
+    if (key.isEmpty())
+        return {};
+
+    int node = 0;
+    qsizetype pos = 0;
+    while (pos < key.size()) {
+        const int child = findChild(node, key.at(pos));
+        if (child == -1)
+            return {};
+        const QString &label = m_nodes.at(child).label;
+        const qsizetype length = qMin(label.size(), key.size() - pos);
+        if (QStringView(label).left(length) != QStringView(key).mid(pos, length))
+            return {};
+        pos += length;
+        node = child;
+    }
+    return m_nodes.at(node).top.mid(0, count);
+}
+
+QList<int> OmniboxIndex::tokenMatches(const QString &text, int count, const std::function<bool()> &cancelled) const
+{
+    const QStringList words = tokenize(text.toLower());
+    if (words.isEmpty() || count <= 0)
+        return {};
+
+    // Les candidats viennent du mot le plus long, a priori le plus sélectif
+    const QString seed = *std::max_element(words.cbegin(), words.cend(), [](const QString &a, const QString &b) {
+        return a.size() < b.size();
+    });
+    if (seed.size() < 2)
+        return {};
+
+    QList<int> best;
+    QSet<int> seen;
+    int visited = 0;
+    for (auto it = m_tokens.lowerBound(seed); it != m_tokens.cend() && it.key().startsWith(seed); ++it) {
+        const QVector<int> &ids = it.value();
+        for (qsizetype i = ids.size() - 1; i >= 0; --i) {
+            if (++visited % CancelCheckInterval == 0 && cancelled())
+                return {};
+            if (visited > MaxTokenCandidates)
+                return best;
+
+            const int id = ids.at(i);
+            const Entry &entry = m_entries.at(id);
+            if (entry.score <= 0 || seen.contains(id))
+                continue;
+            seen.insert(id);
+            const bool matches = std::all_of(words.cbegin(), words.cend(), [&entry](const QString &word) {
+                return hasWordStartingWith(entry.text, word);
+            });
+            if (!matches)
+                continue;
+
+            // Les count meilleurs, triés par insertion
+            auto pos = std::lower_bound(best.begin(), best.end(), id, [this](int a, int b) {
+                return better(a, b);
+            });
+            if (pos - best.begin() < count) {
+                best.insert(pos, id);
+                if (best.size() > count)
+                    best.removeLast();
+            }
+        }
+    }
+    return best;
+}
+
+float OmniboxIndex::frecency(const Entry &entry, qint64 now) const
+{
+    if (entry.visitCount == 0 && !entry.favorite)
+        return 0; // favori retiré jamais visité : plus proposé
+
+    float weight = 10;
+    if (entry.lastVisit > 0) {
+        const qint64 days = qMax<qint64>(0, now - entry.lastVisit) / (24 * 60 * 60);
+        weight = days <= 4 ? 100 : days <= 14 ? 70 : days <= 31 ? 50 : days <= 90 ? 30 : 10;
+    }
+    float score = weight * std::log2(2.0f + entry.visitCount);
+    if (entry.favorite)
+        score += FavoriteBonus;
+    return score;
+}
+
+int OmniboxIndex::insertKey(const QString &key, int id)
+{
+    int node = 0;
+    qsizetype pos = 0;
+    while (pos < key.size()) {
+        const int child = findChild(node, key.at(pos));
+        if (child == -1) {
+            Node leaf;
+            leaf.label = key.mid(pos);
+            leaf.parent = node;
+            leaf.entry = id;
+            const int leafIndex = m_nodes.size();
+            m_nodes.append(leaf);
+            QVector<int> &children = m_nodes[node].children;
+            auto at = std::lower_bound(children.begin(), children.end(), key.at(pos), [this](int index, QChar c) {
+                return m_nodes.at(index).label.at(0) < c;
+            });
+            children.insert(at, leafIndex);
+            return leafIndex;
+        }
+
+        const QString label = m_nodes.at(child).label;
+        qsizetype common = 1;
+        while (common < label.size() && pos + common < key.size() && label.at(common) == key.at(pos + common))
+            ++common;
+        if (common < label.size()) {
+            // L'arête est coupée : un nœud intermédiaire prend le préfixe commun
+            Node middle;
+            middle.label = label.left(common);
+            middle.parent = node;
+            middle.children = {child};
+            middle.top = m_nodes.at(child).top;
+            const int middleIndex = m_nodes.size();
+            m_nodes.append(middle);
+            m_nodes[child].label = label.mid(common);
+            m_nodes[child].parent = middleIndex;
+            QVector<int> &children = m_nodes[node].children;
+            children[children.indexOf(child)] = middleIndex; // même premier caractère
+            node = middleIndex;
+        } else {
+            node = child;
+        }
+        pos += common;
+    }
+    m_nodes[node].entry = id;
+    return node;
+}
+
+int OmniboxIndex::findChild(int node, QChar c) const
+{
+    const QVector<int> &children = m_nodes.at(node).children;
+    auto it = std::lower_bound(children.cbegin(), children.cend(), c, [this](int index, QChar value) {
+        return m_nodes.at(index).label.at(0) < value;
+    });
+    if (it == children.cend() || m_nodes.at(*it).label.at(0) != c)
+        return -1;
+    return *it;
+}
+
+void OmniboxIndex::refresh(int node)
+{
+    // Les listes des enfants sont déjà triées : il suffit de les fusionner
+    const Node &current = m_nodes.at(node);
+    QVector<int> candidates;
+    if (current.entry != -1 && m_entries.at(current.entry).score > 0)
+        candidates.append(current.entry);
+    for (int child : current.children)
+        candidates.append(m_nodes.at(child).top);
+
+    const qsizetype size = qMin<qsizetype>(candidates.size(), TopSize);
+    std::partial_sort(candidates.begin(), candidates.begin() + size, candidates.end(), [this](int a, int b) {
+        return better(a, b);
+    });
+    candidates.resize(size);
+    m_nodes[node].top = candidates;
+}
+
+void OmniboxIndex::refreshPath(int node)
+{
+    for (; node != -1; node = m_nodes.at(node).parent)
+        refresh(node);
+}
+
+void OmniboxIndex::indexTokens(int id, const QString &text, const QString &previous)
+{
+    // Les mots de previous pointent déjà vers id ; les répétitions de text
+    // ne sont ajoutées qu'une fois
+    const QStringList previousTokens = tokenize(previous);
+    QSet<QString> indexed(previousTokens.cbegin(), previousTokens.cend());
+    const QStringList tokens = tokenize(text);
+    for (const QString &token : tokens) {
+        if (token.size() < 2 || indexed.contains(token))
+            continue;
+        indexed.insert(token);
+        m_tokens[token].append(id);
+    }
+}
+
+void OmniboxIndex::updateText(int id)
+{
+    // Seuls les mots nouveaux sont ajoutés à l'index
+    Entry &entry = m_entries[id];
+    const QString previous = entry.text;
+    entry.text = urlKey(entry.url);
+    if (!entry.title.isEmpty())
+        entry.text += QLatin1Char(' ') + entry.title.toLower();
+    if (!entry.favoriteTitle.isEmpty() && entry.favoriteTitle != entry.title)
+        entry.text += QLatin1Char(' ') + entry.favoriteTitle.toLower();
+    indexTokens(id, entry.text, previous);
+}
+
+void OmniboxIndex::releaseFavorite(int id)
+{
+    auto count = m_favoriteCounts.find(id);
+    if (count == m_favoriteCounts.end())
+        return;
+    if (--count.value() > 0)
+        return;
+    m_favoriteCounts.erase(count);
+    // Plus aucun favori : son titre ne fait plus trouver l'adresse
+    if (!m_entries.at(id).favoriteTitle.isEmpty()) {
+        m_entries[id].favoriteTitle.clear();
+        updateText(id);
+    }
+    refreshFavorite(id);
+}
+
+void OmniboxIndex::refreshFavorite(int id)
+{
+    Entry &entry = m_entries[id];
+    const bool favorite = m_favoriteCounts.contains(id);
+    if (entry.favorite == favorite)
+        return;
+    entry.favorite = favorite;
+    entry.score = frecency(entry, m_now);
+    refreshPath(entry.node);
+}
+
+bool OmniboxIndex::better(int a, int b) const
+{
+    const Entry &first = m_entries.at(a);
+    const Entry &second = m_entries.at(b);
+    if (first.score != second.score)
+        return first.score > second.score;
+    if (first.lastVisit != second.lastVisit)
+        return first.lastVisit > second.lastVisit;
+    return a < b;
+}
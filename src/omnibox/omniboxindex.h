@@ -0,0 +1,107 @@
+#ifndef OMNIBOXINDEX_H
+#define OMNIBOXINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+// Index des adresses proposées par la barre d'adresse (historique et
+// favoris), classées par « frecency » : fréquence des visites pondérée par
+// leur ancienneté, avec un bonus pour les favoris.
+//
+// - Un arbre radix compressé sur l'adresse normalisée (sans schéma ni
+//   « www. ») garde dans chaque nœud les meilleures entrées de son
+//   sous-arbre : une recherche par préfixe coûte la longueur du texte tapé,
+//   quel que soit le nombre d'entrées.
+// - Un index des mots (adresse, titre de la page et du favori) retrouve les entrées dont un mot
+//   commence par chacun des mots tapés ; les listes ne sont jamais purgées,
+//   chaque candidat est revérifié sur son texte.
+//
+// Sans verrou : l'index n'est utilisé que depuis le thread d'OmniboxEngine.
+class OmniboxIndex
+{
+public:
+    struct Entry
+    {
+        QString url;
+        QString title;
+        QString favoriteTitle; // titre donné au favori, indexé même sans visite
+        QString text; // clé et titres en minuscules, pour la vérification des mots
+        int visitCount = 0;
+        qint64 lastVisit = 0;
+        bool favorite = false;
+        float score = 0;
+        int node = -1; // nœud terminal dans l'arbre
+    };
+
+    // Taille des listes gardées par nœud : nombre maximal de suggestions
+    static constexpr int TopSize = 12;
+
+    OmniboxIndex();
+
+    static QString urlKey(const QString &url);
+
+    // Ajoute ou met à jour l'entrée de cette adresse, renvoie son id
+    int setEntry(const QString &url, const QString &title, int visitCount, qint64 lastVisit);
+    // Les favoris sont suivis par leur id : plusieurs peuvent désigner la
+    // même adresse, qui reste favorite tant qu'il en reste un
+    struct Favorite
+    {
+        QString url;
+        QString title;
+    };
+    // Remplace tous les favoris (id du favori -> adresse et titre)
+    void setFavorites(const QHash<int, Favorite> &favorites);
+    void setFavorite(int favoriteId, const QString &url, const QString &title);
+    // Faux si l'id n'est pas celui d'un favori connu (dossier...)
+    bool removeFavorite(int favoriteId);
+    int find(const QString &url) const { return m_idByKey.value(urlKey(url), -1); }
+    const Entry &entry(int id) const { return m_entries.at(id); }
+    int size() const { return m_entries.size(); }
+
+    // Recalcule tous les scores (l'ancienneté des visites a changé)
+    void rescore(qint64 now);
+
+    // Meilleures entrées dont l'adresse commence par text
+    QList<int> prefixMatches(const QString &text, int count) const;
+    // Meilleures entrées contenant un mot commençant par chaque mot de text ;
+    // cancelled est consulté régulièrement pour abandonner une recherche dépassée
+    QList<int> tokenMatches(const QString &text, int count, const std::function<bool()> &cancelled) const;
+
+private:
+    struct Node
+    {
+        QString label; // arête depuis le parent
+        int parent = -1;
+        int entry = -1;
+        QVector<int> children; // triés par premier caractère de l'arête
+        QVector<int> top;      // meilleures entrées du sous-arbre, score décroissant
+    };
+
+    float frecency(const Entry &entry, qint64 now) const;
+    int insertKey(const QString &key, int id);
+    int findChild(int node, QChar c) const;
+    void refresh(int node);
+    void refreshPath(int node);
+    void indexTokens(int id, const QString &text, const QString &previous = QString());
+    void updateText(int id);
+    void releaseFavorite(int id);
+    void refreshFavorite(int id);
+    bool better(int a, int b) const;
+
+    QVector<Entry> m_entries;
+    QHash<QString, int> m_idByKey;
+    QVector<Node> m_nodes; // m_nodes[0] est la racine
+    QMap<QString, QVector<int>> m_tokens; // mot -> entrées, dans l'ordre d'ajout
+    QHash<int, int> m_entryByFavorite; // id du favori -> entrée
+    QHash<int, int> m_favoriteCounts;  // entrée -> nombre de favoris qui la désignent
+    qint64 m_now = 0; // date de référence des scores
+};
+
+#endif // OMNIBOXINDEX_H
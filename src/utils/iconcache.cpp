@@ -0,0 +1,142 @@
+#include "iconcache.h"
+
+#include <QFont>
+#include <QGuiApplication>
+#include <QHash>
+#include <QIconEngine>
+#include <QPainter>
+
+namespace {
+
+// Quelques dizaines de lettres par couleur et par écran : la borne ne
+// sert qu'à se protéger de titres exotiques en très grand nombre
+constexpr qsizetype MaxCachedPixmaps = 1024;
+
+struct GlyphKey
+{
+    char16_t glyph;
+    QRgb color;
+    int width;
+    int height;
+    qreal devicePixelRatio;
+
+    bool operator==(const GlyphKey &other) const
+    {
+        return glyph == other.glyph && color == other.color && width == other.width
+            && height == other.height && devicePixelRatio == other.devicePixelRatio;
+    }
+};
+
+size_t qHash(const GlyphKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.glyph, key.color, key.width, key.height, key.devicePixelRatio);
+}
+
+struct Caches
+{
+    QHash<GlyphKey, QPixmap> pixmaps;
+    QHash<quint64, QIcon> icons;
+};
+
+Caches &caches()
+{
+    // Vidés à la destruction de l'application : une QPixmap détruite après
+    // QGuiApplication, avec les variables statiques, n'est pas définie
+    static Caches instance;
+    static const bool registered = []() {
+        qAddPostRoutine([]() {
+            caches().pixmaps.clear();
+            caches().icons.clear();
+        });
+        return true;
+    }();
+    Q_UNUSED(registered);
+    return instance;
+}
+
+QPixmap renderGlyph(QChar glyph, const QColor &color, const QSize &size, qreal devicePixelRatio)
+{
+    QPixmap pix(size * devicePixelRatio);
+    pix.setDevicePixelRatio(devicePixelRatio);
+    pix.fill(Qt::transparent);
+
+    QPainter painter(&pix);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.setPen(color);
+    // Taille en pixels logiques : le rendu suit la taille demandée
+    QFont font("Arial");
+    font.setBold(true);
+    font.setPixelSize(qMax(1, qRound(size.height() * 0.8)));
+    painter.setFont(font);
+    painter.drawText(QRect(QPoint(0, 0), size), Qt::AlignCenter, QString(glyph));
+    return pix;
+}
+
+// Moteur d'icône sans image : chaque demande passe par le cache
+class GlyphIconEngine : public QIconEngine
+{
+public:
+    GlyphIconEngine(QChar glyph, const QColor &color)
+        : m_glyph(glyph)
+        , m_color(color)
+    {
+    }
+
+    void paint(QPainter *painter, const QRect &rect, QIcon::Mode mode, QIcon::State state) override
+    {
+        const qreal ratio = painter->device() ? painter->device()->devicePixelRatio() : qApp->devicePixelRatio();
+        painter->drawPixmap(rect, scaledPixmap(rect.size(), mode, state, ratio));
+    }
+
+    QPixmap pixmap(const QSize &size, QIcon::Mode mode, QIcon::State state) override
+    {
+        return scaledPixmap(size, mode, state, 1.0);
+    }
+
+    QPixmap scaledPixmap(const QSize &size, QIcon::Mode mode, QIcon::State, qreal scale) override
+    {
+        QColor color = m_color;
+        if (mode == QIcon::Disabled)
+            color.setAlphaF(color.alphaF() * 0.4);
+        return IconCache::glyphPixmap(m_glyph, color, size, scale);
+    }
+
+    QIconEngine *clone() const override { return new GlyphIconEngine(m_glyph, m_color); }
+    QString key() const override { return QStringLiteral("GlyphIconEngine"); }
+
+private:
+    QChar m_glyph;
+    QColor m_color;
+};
+
+} // namespace
+
+namespace IconCache {
+
+QIcon glyphIcon(QChar glyph, const QColor &color)
+{
+    const quint64 key = (quint64(glyph.unicode()) << 32) | color.rgba();
+    QHash<quint64, QIcon> &icons = caches().icons;
+    auto it = icons.constFind(key);
+    if (it == icons.constEnd())
+        it = icons.insert(key, QIcon(new GlyphIconEngine(glyph, color)));
+    return it.value();
+}
+
+QPixmap glyphPixmap(QChar glyph, const QColor &color, const QSize &size, qreal devicePixelRatio)
+{
+    if (size.isEmpty())
+        return QPixmap();
+
+    const GlyphKey key{glyph.unicode(), color.rgba(), size.width(), size.height(), devicePixelRatio};
+    QHash<GlyphKey, QPixmap> &pixmaps = caches().pixmaps;
+    auto it = pixmaps.constFind(key);
+    if (it != pixmaps.constEnd())
+        return it.value();
+
+    if (pixmaps.size() >= MaxCachedPixmaps)
+        pixmaps.clear();
+    return pixmaps.insert(key, renderGlyph(glyph, color, size, devicePixelRatio)).value();
+}
+
+} // namespace IconCache
@@ -0,0 +1,22 @@
+#ifndef ICONCACHE_H
+#define ICONCACHE_H
+
+#include <QColor>
+#include <QIcon>
+#include <QPixmap>
+#include <QSize>
+
+// Icônes générées : un caractère dessiné sur fond transparent (lettre d'un
+// favori sans favicon, étoile des favoris...). Chaque combinaison
+// (caractère, couleur, taille, ratio de pixels) n'est rastérisée qu'une
+// fois. Les QIcon renvoyées ne contiennent aucune image : elles demandent
+// leur pixmap au cache au moment de l'affichage, à la densité de l'écran
+// concerné. À n'utiliser que depuis le thread graphique.
+namespace IconCache {
+
+QIcon glyphIcon(QChar glyph, const QColor &color);
+QPixmap glyphPixmap(QChar glyph, const QColor &color, const QSize &size, qreal devicePixelRatio);
+
+} // namespace IconCache
+
+#endif // ICONCACHE_H
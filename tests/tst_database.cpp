@@ -0,0 +1,122 @@
+#include <QDir>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QTest>
+
+#include "database.h"
+
+namespace {
+
+QList<int> ids(const QVector<FavoriteRecord> &records)
+{
+    QList<int> result;
+    for (const FavoriteRecord &record : records)
+        result.append(record.id);
+    return result;
+}
+
+// Clés d'ordre distinctes et croissantes
+bool hasDistinctPositions(const QVector<FavoriteRecord> &records)
+{
+    for (qsizetype i = 1; i < records.size(); ++i) {
+        if (!(records.at(i - 1).position < records.at(i).position))
+            return false;
+    }
+    return true;
+}
+
+}
+
+class TestDatabase : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void movesBetweenSiblings();
+    void movesIntoFolder();
+    void rebalancesEqualPositions();
+};
+
+void TestDatabase::initTestCase()
+{
+    // favorites.db est créé dans le dossier de test de QStandardPaths
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void TestDatabase::init()
+{
+    // Une base vide pour chaque test
+    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir(dataDir).removeRecursively();
+    QVERIFY(QDir().mkpath(dataDir));
+}
+
+void TestDatabase::movesBetweenSiblings()
+{
+    Database database;
+    QVERIFY(database.initDatabase());
+    const int a = database.addFavorite("A", "https://a.example", QString());
+    const int b = database.addFavorite("B", "https://b.example", QString());
+    const int c = database.addFavorite("C", "https://c.example", QString());
+    QCOMPARE(ids(database.getFavorites(0)), QList<int>({a, b, c}));
+
+    QVERIFY(database.moveFavorite(c, 0, a, b));
+    QCOMPARE(ids(database.getFavorites(0)), QList<int>({a, c, b}));
+
+    // Les deux voisins à -1 : en fin de dossier
+    QVERIFY(database.moveFavorite(a, 0, -1, -1));
+    QCOMPARE(ids(database.getFavorites(0)), QList<int>({c, b, a}));
+
+    // Pas de précédent : en tête
+    QVERIFY(database.moveFavorite(b, 0, -1, c));
+    const QVector<FavoriteRecord> root = database.getFavorites(0);
+    QCOMPARE(ids(root), QList<int>({b, c, a}));
+    QVERIFY(hasDistinctPositions(root));
+}
+
+void TestDatabase::movesIntoFolder()
+{
+    Database database;
+    QVERIFY(database.initDatabase());
+    const int folder = database.addFavorite("Dossier", QString(), QString());
+    const int a = database.addFavorite("A", "https://a.example", QString());
+    const int b = database.addFavorite("B", "https://b.example", QString(), folder);
+
+    QVERIFY(database.moveFavorite(a, folder, -1, b));
+    QCOMPARE(ids(database.getFavorites(folder)), QList<int>({a, b}));
+    QCOMPARE(ids(database.getFavorites(0)), QList<int>({folder}));
+    QCOMPARE(database.getFavorites(folder).first().parentId, folder);
+}
+
+void TestDatabase::rebalancesEqualPositions()
+{
+    Database database;
+    QVERIFY(database.initDatabase());
+    const int a = database.addFavorite("A", "https://a.example", QString());
+    const int b = database.addFavorite("B", "https://b.example", QString());
+    const int c = database.addFavorite("C", "https://c.example", QString());
+
+    // Données anciennes ou importées : toutes les clés du dossier se confondent
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "tst_database");
+        db.setDatabaseName(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/favorites.db");
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec("UPDATE favorites SET position = 'i' WHERE parent_id = 0"));
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("tst_database");
+
+    // Aucune clé n'existe entre deux clés égales : le dossier est renuméroté
+    // dans son ordre actuel (position puis id) avant le déplacement
+    QVERIFY(database.moveFavorite(c, 0, a, b));
+    const QVector<FavoriteRecord> root = database.getFavorites(0);
+    QCOMPARE(ids(root), QList<int>({a, c, b}));
+    QVERIFY(hasDistinctPositions(root));
+}
+
+QTEST_GUILESS_MAIN(TestDatabase)
+#include "tst_database.moc"
@@ -0,0 +1,175 @@
+#include <QTest>
+
+#include "favoriteposition.h"
+
+namespace {
+
+const QString Digits = QStringLiteral("0123456789abcdefghijklmnopqrstuvwxyz");
+
+// Toutes les clés valides d'au plus deux chiffres, dans l'ordre
+QStringList shortKeys()
+{
+    QStringList keys;
+    for (QChar first : Digits) {
+        if (first != QLatin1Char('0'))
+            keys.append(QString(first));
+        for (QChar second : Digits) {
+            if (second != QLatin1Char('0'))
+                keys.append(QString(first) + second);
+        }
+    }
+    keys.sort();
+    return keys;
+}
+
+bool isValidKey(const QString &key)
+{
+    if (key.isEmpty() || key.endsWith(QLatin1Char('0')))
+        return false;
+    for (QChar c : key) {
+        if (!Digits.contains(c))
+            return false;
+    }
+    return true;
+}
+
+}
+
+class TestFavoritePosition : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void betweenIsStrictlyBetween_data();
+    void betweenIsStrictlyBetween();
+    void betweenAllShortKeys();
+    void afterIsGreater();
+    void frontInsertionGrowsSlowly();
+    void appendGrowsSlowly();
+    void sequenceIsOrdered_data();
+    void sequenceIsOrdered();
+};
+
+void TestFavoritePosition::betweenIsStrictlyBetween_data()
+{
+    QTest::addColumn<QString>("before");
+    QTest::addColumn<QString>("after");
+
+    QTest::newRow("vide") << QString() << QString();
+    QTest::newRow("sans borne basse") << QString() << QStringLiteral("i");
+    QTest::newRow("sans borne haute") << QStringLiteral("i") << QString();
+    QTest::newRow("écart large") << QStringLiteral("1") << QStringLiteral("z");
+    QTest::newRow("consécutifs") << QStringLiteral("i") << QStringLiteral("j");
+    QTest::newRow("préfixe commun") << QStringLiteral("ab") << QStringLiteral("ac");
+    QTest::newRow("préfixe de after") << QStringLiteral("a") << QStringLiteral("a1");
+    QTest::newRow("suite de after") << QStringLiteral("i") << QStringLiteral("j1");
+    QTest::newRow("premier chiffre") << QString() << QStringLiteral("1");
+    QTest::newRow("dernier chiffre") << QStringLiteral("z") << QString();
+    QTest::newRow("que des z") << QStringLiteral("zzz") << QString();
+    QTest::newRow("zéros internes") << QStringLiteral("001") << QStringLiteral("002");
+}
+
+void TestFavoritePosition::betweenIsStrictlyBetween()
+{
+    QFETCH(QString, before);
+    QFETCH(QString, after);
+
+    const QString key = FavoritePosition::between(before, after);
+    QVERIFY2(isValidKey(key), qPrintable(key));
+    if (!before.isEmpty())
+        QVERIFY2(before < key, qPrintable(key));
+    if (!after.isEmpty())
+        QVERIFY2(key < after, qPrintable(key));
+}
+
+void TestFavoritePosition::betweenAllShortKeys()
+{
+    const QStringList keys = shortKeys();
+    for (qsizetype i = 0; i + 1 < keys.size(); ++i) {
+        const QString key = FavoritePosition::between(keys.at(i), keys.at(i + 1));
+        QVERIFY2(isValidKey(key) && keys.at(i) < key && key < keys.at(i + 1),
+                 qPrintable(keys.at(i) + " " + key + " " + keys.at(i + 1)));
+    }
+}
+
+void TestFavoritePosition::afterIsGreater()
+{
+    QCOMPARE(FavoritePosition::after(QString()), FavoritePosition::between(QString(), QString()));
+    for (const QString &key : shortKeys() + QStringList{"zz", "zzz", "az", "0z"}) {
+        const QString next = FavoritePosition::after(key);
+        QVERIFY2(isValidKey(next) && key < next, qPrintable(key + " " + next));
+        QVERIFY(next.size() <= key.size() + 1);
+    }
+}
+
+void TestFavoritePosition::frontInsertionGrowsSlowly()
+{
+    // Chaque insertion en tête coupe l'intervalle restant en deux : un peu
+    // plus de cinq insertions par chiffre en base 36
+    constexpr int Count = 1000;
+    QString first = FavoritePosition::between(QString(), QString());
+    for (int i = 0; i < Count; ++i) {
+        const QString key = FavoritePosition::between(QString(), first);
+        QVERIFY(isValidKey(key));
+        QVERIFY(key < first);
+        first = key;
+    }
+    QVERIFY2(first.size() <= Count / 4 + 2, qPrintable(QString::number(first.size())));
+
+    // Même chose au milieu d'un dossier, toujours juste après le même voisin
+    QString next = QStringLiteral("j");
+    for (int i = 0; i < Count; ++i) {
+        const QString key = FavoritePosition::between(QStringLiteral("i"), next);
+        QVERIFY(QStringLiteral("i") < key && key < next);
+        next = key;
+    }
+    QVERIFY2(next.size() <= Count / 4 + 2, qPrintable(QString::number(next.size())));
+}
+
+void TestFavoritePosition::appendGrowsSlowly()
+{
+    // Ajouts en fin de dossier : un chiffre de plus toutes les 35 clés
+    constexpr int Count = 1000;
+    QString last;
+    for (int i = 0; i < Count; ++i) {
+        const QString key = FavoritePosition::after(last);
+        QVERIFY(last < key);
+        last = key;
+    }
+    QVERIFY2(last.size() <= Count / 30 + 2, qPrintable(QString::number(last.size())));
+}
+
+void TestFavoritePosition::sequenceIsOrdered_data()
+{
+    QTest::addColumn<QString>("key");
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("maxLength");
+
+    QTest::newRow("une") << QString() << 1 << 1;
+    QTest::newRow("un chiffre") << QString() << 35 << 1;
+    QTest::newRow("deux chiffres") << QString() << 36 << 2;
+    QTest::newRow("mille") << QString() << 1000 << 2;
+    QTest::newRow("après une clé") << QStringLiteral("5") << 100 << 3;
+    QTest::newRow("après des z") << QStringLiteral("zz") << 10 << 4;
+}
+
+void TestFavoritePosition::sequenceIsOrdered()
+{
+    QFETCH(QString, key);
+    QFETCH(int, count);
+    QFETCH(int, maxLength);
+
+    const QStringList keys = FavoritePosition::sequence(key, count);
+    QCOMPARE(keys.size(), count);
+    QString previous = key;
+    for (const QString &next : keys) {
+        QVERIFY2(isValidKey(next), qPrintable(next));
+        QVERIFY2(previous < next, qPrintable(previous + " " + next));
+        QVERIFY2(next.size() <= maxLength, qPrintable(next));
+        previous = next;
+    }
+    QVERIFY(FavoritePosition::sequence(key, 0).isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestFavoritePosition)
+#include "tst_favoriteposition.moc"
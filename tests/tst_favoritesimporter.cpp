@@ -0,0 +1,218 @@
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "database.h"
+#include "favoritesimporter.h"
+
+namespace {
+
+// Dossiers imbriqués, titre vide et URL nulle : les cas qui faisaient
+// échouer l'insertion dans les colonnes NOT NULL
+const QByteArray NestedJson = R"([
+    {
+        "title": "Mes favoris",
+        "folder": true,
+        "children": [
+            {
+                "title": "Sous-dossier",
+                "folder": true,
+                "children": [
+                    { "title": "", "url": "https://duckduckgo.com/", "favicon": "" },
+                    { "title": "Vide", "folder": true, "url": null, "children": [] }
+                ]
+            }
+        ]
+    },
+    { "title": "Google", "url": "https://google.fr" }
+])";
+
+// Ancien format à plat : la hiérarchie passe par id / parent_id, y compris
+// vers un dossier écrit plus loin, et une boucle de parent_id
+const QByteArray FlatJson = R"([
+    { "id": 1, "title": "Travail", "folder": true, "parent_id": 0 },
+    { "id": 2, "title": "Docs", "url": "https://doc.qt.io", "parent_id": 1 },
+    { "id": 3, "title": "Projets", "folder": true, "parent_id": 1 },
+    { "id": 4, "title": "Qt", "url": "https://qt.io", "parent_id": 3 },
+    { "id": 5, "title": "Racine", "url": "https://example.org" },
+    { "id": 6, "title": "Plus tard", "url": "https://later.example", "parent_id": 7 },
+    { "id": 7, "title": "Dossier tardif", "folder": true },
+    { "id": 8, "title": "A", "folder": true, "parent_id": 9 },
+    { "id": 9, "title": "B", "folder": true, "parent_id": 8 },
+    { "id": 10, "title": "Sous un favori", "url": "https://orphan.example", "parent_id": 5 }
+])";
+
+QString writeFile(const QTemporaryDir &dir, const QByteArray &json)
+{
+    const QString path = dir.filePath("favorites.json");
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly))
+        file.write(json);
+    return path;
+}
+
+QHash<QString, FavoriteRecord> readByTitle(const QByteArray &json, int firstId)
+{
+    QBuffer buffer;
+    buffer.setData(json);
+    buffer.open(QIODevice::ReadOnly);
+    FavoritesImporter importer(firstId);
+    QHash<QString, FavoriteRecord> byTitle;
+    if (!importer.read(&buffer))
+        return byTitle;
+    for (const FavoriteRecord &record : importer.records())
+        byTitle.insert(record.title, record);
+    return byTitle;
+}
+
+}
+
+class TestFavoritesImporter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void readsNestedFolders();
+    void importsNestedFolders();
+    void readsFlatFormat();
+    void importsFlatFormat();
+};
+
+void TestFavoritesImporter::initTestCase()
+{
+    // favorites.db est créé dans le dossier de test de QStandardPaths
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void TestFavoritesImporter::init()
+{
+    // Une base vide pour chaque test
+    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir(dataDir).removeRecursively();
+    QVERIFY(QDir().mkpath(dataDir));
+}
+
+void TestFavoritesImporter::readsNestedFolders()
+{
+    QBuffer buffer;
+    buffer.setData(NestedJson);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    FavoritesImporter importer(1);
+    QVERIFY2(importer.read(&buffer), qPrintable(importer.errorString()));
+
+    const QVector<FavoriteRecord> &records = importer.records();
+    QCOMPARE(records.size(), 5);
+    for (const FavoriteRecord &record : records) {
+        QVERIFY(!record.title.isNull());
+        QVERIFY(!record.url.isNull());
+    }
+
+    // Les enfants sont écrits avant leur dossier, qui reçoit son id à l'ouverture
+    QHash<QString, FavoriteRecord> byTitle;
+    for (const FavoriteRecord &record : records)
+        byTitle.insert(record.title, record);
+    QVERIFY(byTitle.value("Mes favoris").isFolder());
+    QCOMPARE(byTitle.value("Mes favoris").parentId, 0);
+    QCOMPARE(byTitle.value("Sous-dossier").parentId, byTitle.value("Mes favoris").id);
+    QCOMPARE(byTitle.value("Vide").parentId, byTitle.value("Sous-dossier").id);
+    QVERIFY(byTitle.value("Vide").isFolder());
+    QCOMPARE(byTitle.value("").url, QStringLiteral("https://duckduckgo.com/"));
+    QCOMPARE(byTitle.value("").parentId, byTitle.value("Sous-dossier").id);
+    QCOMPARE(byTitle.value("Google").parentId, 0);
+}
+
+void TestFavoritesImporter::importsNestedFolders()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = writeFile(dir, NestedJson);
+
+    Database database;
+    QVERIFY(database.initDatabase());
+    QVERIFY(database.migrateFromJson(path));
+
+    const QVector<FavoriteRecord> root = database.getFavorites(0);
+    QCOMPARE(root.size(), 2);
+    QCOMPARE(root.at(0).title, QStringLiteral("Mes favoris"));
+    QVERIFY(root.at(0).isFolder());
+    QCOMPARE(root.at(1).url, QStringLiteral("https://google.fr"));
+
+    const QVector<FavoriteRecord> folder = database.getFavorites(root.at(0).id);
+    QCOMPARE(folder.size(), 1);
+    QCOMPARE(folder.at(0).title, QStringLiteral("Sous-dossier"));
+
+    const QVector<FavoriteRecord> nested = database.getFavorites(folder.at(0).id);
+    QCOMPARE(nested.size(), 2);
+    QCOMPARE(nested.at(0).url, QStringLiteral("https://duckduckgo.com/"));
+    QVERIFY(nested.at(0).title.isEmpty());
+    QVERIFY(nested.at(1).isFolder());
+    QVERIFY(database.isFavoriteUrl(QUrl("https://duckduckgo.com/")));
+}
+
+void TestFavoritesImporter::readsFlatFormat()
+{
+    // Les ids du fichier sont remplacés par ceux attribués à partir de firstId
+    const QHash<QString, FavoriteRecord> byTitle = readByTitle(FlatJson, 100);
+    QCOMPARE(byTitle.size(), 10);
+
+    QVERIFY(byTitle.value("Travail").isFolder());
+    QCOMPARE(byTitle.value("Travail").parentId, 0);
+    QCOMPARE(byTitle.value("Docs").parentId, byTitle.value("Travail").id);
+    QCOMPARE(byTitle.value("Projets").parentId, byTitle.value("Travail").id);
+    QVERIFY(byTitle.value("Projets").isFolder());
+    QCOMPARE(byTitle.value("Qt").parentId, byTitle.value("Projets").id);
+    QCOMPARE(byTitle.value("Racine").parentId, 0);
+    QCOMPARE(byTitle.value("Plus tard").parentId, byTitle.value("Dossier tardif").id);
+    // Un favori n'est pas un dossier : l'entrée reste à la racine
+    QCOMPARE(byTitle.value("Sous un favori").parentId, 0);
+
+    // La boucle A -> B -> A est coupée : l'un des deux revient à la racine
+    const FavoriteRecord a = byTitle.value("A");
+    const FavoriteRecord b = byTitle.value("B");
+    QVERIFY((a.parentId == 0 && b.parentId == a.id) || (b.parentId == 0 && a.parentId == b.id));
+    for (const FavoriteRecord &record : byTitle)
+        QVERIFY(record.id >= 100);
+}
+
+void TestFavoritesImporter::importsFlatFormat()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = writeFile(dir, FlatJson);
+
+    Database database;
+    QVERIFY(database.initDatabase());
+    QVERIFY(database.migrateFromJson(path));
+
+    QHash<QString, FavoriteRecord> root;
+    for (const FavoriteRecord &record : database.getFavorites(0))
+        root.insert(record.title, record);
+    QCOMPARE(root.size(), 5);
+    QVERIFY(root.contains("Travail"));
+    QVERIFY(root.contains("Racine"));
+    QVERIFY(root.contains("Dossier tardif"));
+    QVERIFY(root.contains("Sous un favori"));
+
+    // Dans l'ordre du fichier
+    const QVector<FavoriteRecord> work = database.getFavorites(root.value("Travail").id);
+    QCOMPARE(work.size(), 2);
+    QCOMPARE(work.at(0).title, QStringLiteral("Docs"));
+    QCOMPARE(work.at(1).title, QStringLiteral("Projets"));
+
+    const QVector<FavoriteRecord> projects = database.getFavorites(work.at(1).id);
+    QCOMPARE(projects.size(), 1);
+    QCOMPARE(projects.at(0).url, QStringLiteral("https://qt.io"));
+
+    const QVector<FavoriteRecord> later = database.getFavorites(root.value("Dossier tardif").id);
+    QCOMPARE(later.size(), 1);
+    QCOMPARE(later.at(0).title, QStringLiteral("Plus tard"));
+}
+
+QTEST_GUILESS_MAIN(TestFavoritesImporter)
+#include "tst_favoritesimporter.moc"
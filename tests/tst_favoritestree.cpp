@@ -0,0 +1,148 @@
+#include <QTest>
+
+#include "favoritestree.h"
+
+namespace {
+
+FavoriteRecord folder(int id, int parentId, const QString &title)
+{
+    FavoriteRecord record;
+    record.id = id;
+    record.parentId = parentId;
+    record.title = title;
+    return record;
+}
+
+FavoriteRecord favorite(int id, int parentId, const QString &title)
+{
+    FavoriteRecord record = folder(id, parentId, title);
+    record.url = QStringLiteral("https://example.org/%1").arg(id);
+    return record;
+}
+
+}
+
+class TestFavoritesTree : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void assignsOutOfOrderRecords();
+    void assignBreaksCycles();
+    void reusesFreedNodes();
+    void movesWithinAndAcrossFolders();
+};
+
+void TestFavoritesTree::assignsOutOfOrderRecords()
+{
+    // Les enfants arrivent avant leur dossier
+    FavoritesTree tree;
+    tree.assign({
+        favorite(3, 2, "Qt"),
+        favorite(4, 2, "Docs"),
+        folder(2, 1, "Projets"),
+        folder(1, 0, "Travail"),
+        favorite(5, 0, "Racine"),
+        favorite(6, 42, "Parent inconnu"),
+    });
+
+    QCOMPARE(tree.size(), 6);
+    QCOMPARE(tree.children(FavoritesTree::RootId), QList<int>({1, 5, 6}));
+    QCOMPARE(tree.children(1), QList<int>({2}));
+    QCOMPARE(tree.children(2), QList<int>({3, 4}));
+    QCOMPARE(tree.parentId(3), 2);
+    QVERIFY(tree.isFolder(2));
+    QVERIFY(!tree.isFolder(3));
+    QVERIFY(tree.isAncestorOf(1, 4));
+    QCOMPARE(tree.subtree(1), QList<int>({3, 4, 2, 1}));
+}
+
+void TestFavoritesTree::assignBreaksCycles()
+{
+    FavoritesTree tree;
+    tree.assign({
+        folder(1, 2, "A"),
+        folder(2, 1, "B"),
+        folder(3, 3, "Lui-même"),
+        favorite(4, 1, "Dans A"),
+    });
+
+    // Un des deux dossiers de la boucle revient à la racine, l'autre reste dessous
+    QCOMPARE(tree.size(), 4);
+    const int top = tree.parentId(1) == FavoritesTree::RootId ? 1 : 2;
+    const int nested = top == 1 ? 2 : 1;
+    QCOMPARE(tree.parentId(top), FavoritesTree::RootId);
+    QCOMPARE(tree.parentId(nested), top);
+    QVERIFY(!tree.isAncestorOf(nested, top));
+    QCOMPARE(tree.parentId(3), FavoritesTree::RootId);
+    QCOMPARE(tree.parentId(4), 1);
+
+    // Chaque nœud est atteignable une seule fois depuis la racine
+    const QList<int> all = tree.subtree(top);
+    QCOMPARE(all.size(), 3);
+    QCOMPARE(tree.childCount(FavoritesTree::RootId), 2);
+}
+
+void TestFavoritesTree::reusesFreedNodes()
+{
+    FavoritesTree tree;
+    tree.assign({
+        folder(1, 0, "Dossier"),
+        favorite(2, 1, "Un"),
+        favorite(3, 1, "Deux"),
+        folder(4, 1, "Sous-dossier"),
+        favorite(5, 4, "Trois"),
+        favorite(6, 0, "Racine"),
+    });
+
+    QCOMPARE(tree.remove(1), QList<int>({2, 3, 5, 4, 1}));
+    QCOMPARE(tree.size(), 1);
+    for (int id : {1, 2, 3, 4, 5})
+        QVERIFY(!tree.contains(id));
+    QCOMPARE(tree.children(FavoritesTree::RootId), QList<int>({6}));
+
+    // Les emplacements libérés sont repris sans rien garder de leurs anciens liens
+    QVERIFY(tree.insert(folder(7, 0, "Nouveau")));
+    QVERIFY(tree.insert(favorite(8, 7, "Dedans")));
+    QVERIFY(tree.insert(favorite(9, 0, "Devant"), 0));
+    QCOMPARE(tree.size(), 4);
+    QCOMPARE(tree.children(FavoritesTree::RootId), QList<int>({9, 6, 7}));
+    QCOMPARE(tree.children(7), QList<int>({8}));
+    QCOMPARE(tree.childCount(8), 0);
+    QCOMPARE(tree.title(8), QStringLiteral("Dedans"));
+    QCOMPARE(tree.url(8), QStringLiteral("https://example.org/8"));
+    QVERIFY(tree.iconPath(8).isEmpty());
+    QCOMPARE(tree.nextSibling(6), 7);
+    QCOMPARE(tree.nextSibling(7), -1);
+
+    // Un id déjà présent est refusé
+    QVERIFY(!tree.insert(favorite(8, 0, "Doublon")));
+    QCOMPARE(tree.size(), 4);
+}
+
+void TestFavoritesTree::movesWithinAndAcrossFolders()
+{
+    FavoritesTree tree;
+    tree.assign({
+        folder(1, 0, "Dossier"),
+        favorite(2, 0, "A"),
+        favorite(3, 0, "B"),
+        favorite(4, 0, "C"),
+    });
+
+    QVERIFY(tree.move(4, FavoritesTree::RootId, 1));
+    QCOMPARE(tree.children(FavoritesTree::RootId), QList<int>({1, 4, 2, 3}));
+    QCOMPARE(tree.rowOf(4), 1);
+
+    QVERIFY(tree.move(2, 1));
+    QCOMPARE(tree.children(1), QList<int>({2}));
+    QCOMPARE(tree.childAt(FavoritesTree::RootId, 2), 3);
+
+    // Un dossier ne peut pas entrer dans son propre sous-arbre
+    QVERIFY(tree.insert(folder(5, 1, "Sous-dossier")));
+    QVERIFY(!tree.move(1, 5));
+    QCOMPARE(tree.parentId(1), FavoritesTree::RootId);
+}
+
+QTEST_GUILESS_MAIN(TestFavoritesTree)
+#include "tst_favoritestree.moc"
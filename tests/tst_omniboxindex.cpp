@@ -0,0 +1,163 @@
+#include <QDateTime>
+#include <QTest>
+
+#include "omniboxindex.h"
+
+namespace {
+
+constexpr qint64 Day = 24 * 60 * 60;
+
+bool never()
+{
+    return false;
+}
+
+}
+
+class TestOmniboxIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void normalizesKeys();
+    void prefixAndTokenMatches();
+    void ranksByFrecency();
+    void indexesFavoriteTitles();
+    void tracksFavoritesById();
+};
+
+void TestOmniboxIndex::normalizesKeys()
+{
+    QCOMPARE(OmniboxIndex::urlKey("https://www.Qt.io/"), QStringLiteral("qt.io"));
+    QCOMPARE(OmniboxIndex::urlKey("http://qt.io/doc/"), QStringLiteral("qt.io/doc/"));
+    QCOMPARE(OmniboxIndex::urlKey("  qt.io  "), QStringLiteral("qt.io"));
+
+    OmniboxIndex index;
+    const int id = index.setEntry("https://www.qt.io/", "Qt", 1, QDateTime::currentSecsSinceEpoch());
+    QCOMPARE(index.setEntry("http://qt.io", QString(), 2, QDateTime::currentSecsSinceEpoch()), id);
+    QCOMPARE(index.size(), 1);
+    QCOMPARE(index.entry(id).title, QStringLiteral("Qt"));
+    QCOMPARE(index.entry(id).visitCount, 2);
+}
+
+void TestOmniboxIndex::prefixAndTokenMatches()
+{
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    OmniboxIndex index;
+    index.rescore(now);
+    const int qt = index.setEntry("https://www.qt.io/", "Qt", 5, now);
+    const int tutorial = index.setEntry("https://example.org/qt-tutorial", "Learn Qt", 50, now);
+    const int quora = index.setEntry("https://quora.com/", "Quora", 1, now);
+
+    // Par préfixe : seules les adresses qui commencent par le texte
+    QCOMPARE(index.prefixMatches("qt", 10), QList<int>({qt}));
+    QCOMPARE(index.prefixMatches("q", 10), QList<int>({qt, quora}));
+    QCOMPARE(index.prefixMatches("https://www.qt", 10), QList<int>({qt}));
+    QCOMPARE(index.prefixMatches("q", 1), QList<int>({qt}));
+    QVERIFY(index.prefixMatches("zz", 10).isEmpty());
+
+    // Par mots : un mot de l'adresse ou du titre commence par chaque mot tapé
+    QCOMPARE(index.tokenMatches("qt", 10, never), QList<int>({tutorial, qt}));
+    QCOMPARE(index.tokenMatches("learn qt", 10, never), QList<int>({tutorial}));
+    QCOMPARE(index.tokenMatches("tuto", 10, never), QList<int>({tutorial}));
+    QVERIFY(index.tokenMatches("utorial", 10, never).isEmpty());
+    QVERIFY(index.tokenMatches("q", 10, never).isEmpty());
+}
+
+void TestOmniboxIndex::ranksByFrecency()
+{
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    OmniboxIndex index;
+    index.rescore(now);
+    // Beaucoup de visites anciennes, peu de visites récentes, peu de visites très anciennes
+    const int often = index.setEntry("https://site.example/a", QString(), 10, now - 60 * Day);
+    const int recent = index.setEntry("https://site.example/b", QString(), 2, now);
+    const int old = index.setEntry("https://site.example/c", QString(), 2, now - 200 * Day);
+    const int unvisited = index.setEntry("https://site.example/d", QString(), 0, 0);
+
+    QVERIFY(index.entry(unvisited).score <= 0);
+    QCOMPARE(index.prefixMatches("site.example/", 10), QList<int>({recent, often, old}));
+
+    // Cent jours plus tard, les visites récentes ne le sont plus ; à score
+    // égal, la visite la plus récente passe devant
+    index.rescore(now + 100 * Day);
+    QCOMPARE(index.prefixMatches("site.example/", 10), QList<int>({often, recent, old}));
+
+    // Le bonus des favoris l'emporte sur l'ancienneté, et fait proposer une
+    // adresse jamais visitée
+    index.setFavorite(1, "https://site.example/c", "C");
+    QCOMPARE(index.prefixMatches("site.example/", 10), QList<int>({old, often, recent}));
+    index.setFavorite(2, "https://site.example/d", "D");
+    QCOMPARE(index.prefixMatches("site.example/", 10), QList<int>({old, unvisited, often, recent}));
+}
+
+void TestOmniboxIndex::indexesFavoriteTitles()
+{
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    OmniboxIndex index;
+    index.rescore(now);
+
+    // Jamais visité : le titre du favori suffit à le retrouver
+    index.setFavorite(7, "https://docs.example/", "Documentation interne");
+    const int docs = index.find("https://docs.example/");
+    QVERIFY(docs != -1);
+    QVERIFY(index.entry(docs).favorite);
+    QVERIFY(index.entry(docs).title.isEmpty());
+    QCOMPARE(index.entry(docs).favoriteTitle, QStringLiteral("Documentation interne"));
+    QCOMPARE(index.tokenMatches("documentation", 10, never), QList<int>({docs}));
+    QCOMPARE(index.prefixMatches("docs", 10), QList<int>({docs}));
+
+    // Une visite donne le titre de la page sans perdre celui du favori
+    index.setEntry("https://docs.example/", "Accueil", 1, now);
+    QCOMPARE(index.entry(docs).title, QStringLiteral("Accueil"));
+    QCOMPARE(index.tokenMatches("interne", 10, never), QList<int>({docs}));
+    QCOMPARE(index.tokenMatches("accueil", 10, never), QList<int>({docs}));
+
+    // Renommé : l'ancien titre ne le retrouve plus
+    index.setFavorite(7, "https://docs.example/", "Wiki");
+    QCOMPARE(index.tokenMatches("wiki", 10, never), QList<int>({docs}));
+    QVERIFY(index.tokenMatches("interne", 10, never).isEmpty());
+}
+
+void TestOmniboxIndex::tracksFavoritesById()
+{
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    OmniboxIndex index;
+    index.rescore(now);
+
+    // Deux favoris sur la même adresse : elle reste favorite jusqu'au dernier
+    index.setFavorite(1, "https://shared.example/", "Un");
+    index.setFavorite(2, "https://shared.example/", "Deux");
+    const int shared = index.find("https://shared.example/");
+    QVERIFY(index.removeFavorite(1));
+    QVERIFY(index.entry(shared).favorite);
+    QVERIFY(!index.removeFavorite(1));
+    QVERIFY(index.removeFavorite(2));
+    QVERIFY(!index.entry(shared).favorite);
+    QVERIFY(index.entry(shared).favoriteTitle.isEmpty());
+    // Jamais visitée et plus favorite : plus proposée
+    QVERIFY(index.prefixMatches("shared", 10).isEmpty());
+    QVERIFY(index.tokenMatches("deux", 10, never).isEmpty());
+
+    // Adresse modifiée : le favori passe d'une entrée à l'autre
+    index.setFavorite(3, "https://old.example/", "Site");
+    index.setFavorite(3, "https://new.example/", "Site");
+    QVERIFY(!index.entry(index.find("https://old.example/")).favorite);
+    QVERIFY(index.entry(index.find("https://new.example/")).favorite);
+
+    // Relecture complète : les favoris absents disparaissent
+    index.setFavorites({{3, {"https://new.example/", "Site"}}, {4, {"https://other.example/", "Autre"}}});
+    index.setFavorites({{4, {"https://other.example/", "Autre"}}});
+    QVERIFY(!index.entry(index.find("https://new.example/")).favorite);
+    QVERIFY(index.entry(index.find("https://other.example/")).favorite);
+    QVERIFY(!index.removeFavorite(3));
+
+    // Une adresse vide n'est pas indexée
+    const int size = index.size();
+    index.setFavorite(5, QString(), "Vide");
+    QCOMPARE(index.size(), size);
+    QVERIFY(!index.removeFavorite(5));
+}
+
+QTEST_GUILESS_MAIN(TestOmniboxIndex)
+#include "tst_omniboxindex.moc"
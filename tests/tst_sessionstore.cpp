@@ -0,0 +1,183 @@
+#include <QDir>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QTest>
+
+#include "sessionstore.h"
+
+namespace {
+
+QString sessionPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/session.db";
+}
+
+}
+
+class TestSessionStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void loadsJournaledWrites();
+    void keepsWritesAcrossRestart();
+    void prunesEmptyWindows();
+    void adoptsTabs();
+    void upgradesOldSchema();
+};
+
+void TestSessionStore::initTestCase()
+{
+    // session.db est créé dans le dossier de test de QStandardPaths
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void TestSessionStore::init()
+{
+    // Une session vide pour chaque test
+    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir(dataDir).removeRecursively();
+    QVERIFY(QDir().mkpath(dataDir));
+}
+
+void TestSessionStore::loadsJournaledWrites()
+{
+    SessionStore store;
+    QVERIFY(store.open());
+    const int window = store.addWindow();
+    QVERIFY(window != -1);
+    const int second = store.addTab(window, "r");
+    const int first = store.addTab(window, "i");
+    store.updateTab(first, QUrl("https://qt.io"), "Qt", QByteArray("historique"), QByteArray("png"));
+    store.setCurrentTab(window, second);
+
+    // Les écritures sont encore dans la transaction en cours : load() la valide d'abord
+    const QList<SessionStore::Window> windows = store.load();
+    QCOMPARE(windows.size(), 1);
+    QCOMPARE(windows.at(0).id, window);
+    QCOMPARE(windows.at(0).currentTab, second);
+    const QList<SessionStore::Tab> &tabs = windows.at(0).tabs;
+    QCOMPARE(tabs.size(), 2);
+    // Dans l'ordre des positions, pas de création
+    QCOMPARE(tabs.at(0).id, first);
+    QCOMPARE(tabs.at(0).position, QStringLiteral("i"));
+    QCOMPARE(tabs.at(0).url, QUrl("https://qt.io"));
+    QCOMPARE(tabs.at(0).title, QStringLiteral("Qt"));
+    QCOMPARE(tabs.at(0).history, QByteArray("historique"));
+    QCOMPARE(tabs.at(0).icon, QByteArray("png"));
+    QCOMPARE(tabs.at(1).id, second);
+    QVERIFY(tabs.at(1).url.isEmpty());
+    QVERIFY(tabs.at(1).icon.isEmpty());
+}
+
+void TestSessionStore::keepsWritesAcrossRestart()
+{
+    int window = -1;
+    int tab = -1;
+    {
+        SessionStore store;
+        QVERIFY(store.open());
+        window = store.addWindow();
+        tab = store.addTab(window, "i");
+        store.updateTab(tab, QUrl("https://example.org"), "Exemple", QByteArray(), QByteArray());
+        store.moveTab(tab, "m");
+        // Pas de commit explicite : la fermeture valide la transaction
+    }
+
+    SessionStore store;
+    QVERIFY(store.open());
+    const QList<SessionStore::Window> windows = store.load();
+    QCOMPARE(windows.size(), 1);
+    QCOMPARE(windows.at(0).id, window);
+    QCOMPARE(windows.at(0).tabs.size(), 1);
+    QCOMPARE(windows.at(0).tabs.at(0).id, tab);
+    QCOMPARE(windows.at(0).tabs.at(0).position, QStringLiteral("m"));
+    QCOMPARE(windows.at(0).tabs.at(0).url, QUrl("https://example.org"));
+}
+
+void TestSessionStore::prunesEmptyWindows()
+{
+    {
+        SessionStore store;
+        QVERIFY(store.open());
+        const int kept = store.addWindow();
+        store.addTab(kept, "i");
+        store.addWindow(); // fermée pendant un arrêt brutal, avant son premier onglet
+        const int emptied = store.addWindow();
+        store.removeTab(store.addTab(emptied, "i"));
+    }
+
+    SessionStore store;
+    QVERIFY(store.open());
+    QCOMPARE(store.load().size(), 1);
+    store.commit();
+
+    // Les fenêtres vides ont aussi disparu de la base
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "tst_sessionstore");
+    db.setDatabaseName(sessionPath());
+    QVERIFY(db.open());
+    {
+        QSqlQuery query(db);
+        QVERIFY(query.exec("SELECT COUNT(*) FROM windows"));
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0).toInt(), 1);
+    }
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase("tst_sessionstore");
+}
+
+void TestSessionStore::adoptsTabs()
+{
+    SessionStore store;
+    QVERIFY(store.open());
+    const int previous = store.addWindow();
+    const int tab = store.addTab(previous, "i");
+    const int window = store.addWindow();
+
+    // La fenêtre restaurée reprend les onglets de l'ancienne, qui disparaît
+    store.adoptWindow(previous, window);
+    const QList<SessionStore::Window> windows = store.load();
+    QCOMPARE(windows.size(), 1);
+    QCOMPARE(windows.at(0).id, window);
+    QCOMPARE(windows.at(0).tabs.size(), 1);
+    QCOMPARE(windows.at(0).tabs.at(0).id, tab);
+}
+
+void TestSessionStore::upgradesOldSchema()
+{
+    // Session écrite avant l'ajout de la colonne icon
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "tst_sessionstore");
+        db.setDatabaseName(sessionPath());
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec("CREATE TABLE windows (id INTEGER PRIMARY KEY, current_tab INTEGER NOT NULL DEFAULT -1)"));
+        QVERIFY(query.exec("CREATE TABLE tabs (id INTEGER PRIMARY KEY, window_id INTEGER NOT NULL, "
+                           "position TEXT NOT NULL, url TEXT, title TEXT, history BLOB)"));
+        QVERIFY(query.exec("INSERT INTO windows (id, current_tab) VALUES (1, 1)"));
+        QVERIFY(query.exec("INSERT INTO tabs (id, window_id, position, url, title) "
+                           "VALUES (1, 1, 'i', 'https://qt.io', 'Qt')"));
+        query.finish();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("tst_sessionstore");
+
+    SessionStore store;
+    QVERIFY(store.open());
+    QList<SessionStore::Window> windows = store.load();
+    QCOMPARE(windows.size(), 1);
+    QCOMPARE(windows.at(0).tabs.size(), 1);
+    QCOMPARE(windows.at(0).tabs.at(0).url, QUrl("https://qt.io"));
+    QVERIFY(windows.at(0).tabs.at(0).icon.isEmpty());
+
+    store.updateTab(1, QUrl("https://qt.io"), "Qt", QByteArray(), QByteArray("png"));
+    windows = store.load();
+    QCOMPARE(windows.at(0).tabs.at(0).icon, QByteArray("png"));
+}
+
+QTEST_GUILESS_MAIN(TestSessionStore)
+#include "tst_sessionstore.moc"